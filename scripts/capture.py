@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Record the audio streamed back by a CONFIG_SYNTH_CAPTURE build to a WAV file.
+
+    scripts/capture.py /dev/ttyACM0 take.wav
+
+Recording stops on Ctrl-C. Each block is checked against its CRC-32, and
+blocks dropped by the firmware are reported and replaced with silence so the
+timing is preserved. Console text between the frames is passed through.
+"""
+
+import argparse
+import pathlib
+import struct
+import sys
+import wave
+import zlib
+
+SYNC = 0xA5
+FRAME_CAPTURE = 0x10
+FRAME_CAPTURE_END = 0x11
+
+SAMPLING_FREQUENCY = 44100
+CHANNEL_COUNT = 2
+BLOCK_SIZE = SAMPLING_FREQUENCY * 50 * CHANNEL_COUNT // 1000 * 2
+
+
+def frames(port):
+    """Yield (type, payload) for each valid frame, echoing the bytes in between."""
+    while True:
+        byte = port.read(1)
+        if not byte:
+            return
+        if byte[0] != SYNC:
+            sys.stdout.buffer.write(byte)
+            sys.stdout.flush()
+            continue
+
+        header = port.read(2)
+        if len(header) < 2:
+            return
+        frame_type, length = header
+        rest = port.read(length + 1)
+        if len(rest) < length + 1:
+            return
+        if (frame_type + length + sum(rest)) & 0xFF:
+            print("capture: dropped frame with a bad checksum", file=sys.stderr)
+            continue
+        yield frame_type, rest[:length]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", type=pathlib.Path, help="USB serial port")
+    parser.add_argument("output", type=pathlib.Path, help="WAV file to write")
+    args = parser.parse_args()
+
+    expected = None
+    pcm = bytearray()
+    blocks = lost = 0
+
+    with open(args.port, "rb", buffering=0) as port, \
+            wave.open(str(args.output), "wb") as wav:
+        wav.setnchannels(CHANNEL_COUNT)
+        wav.setsampwidth(2)
+        wav.setframerate(SAMPLING_FREQUENCY)
+
+        try:
+            for frame_type, payload in frames(port):
+                if frame_type == FRAME_CAPTURE:
+                    _, offset = struct.unpack_from("<IH", payload)
+                    if offset != len(pcm):
+                        # Joined mid-block, or a frame went missing.
+                        pcm.clear()
+                        continue
+                    pcm += payload[6:]
+                elif frame_type == FRAME_CAPTURE_END:
+                    block, dropped, crc = struct.unpack("<III", payload)
+                    if expected is None and len(pcm) != BLOCK_SIZE:
+                        # Started listening mid-block.
+                        pcm.clear()
+                        continue
+                    if len(pcm) != BLOCK_SIZE or zlib.crc32(pcm) != crc:
+                        print(f"capture: block {block} is corrupt", file=sys.stderr)
+                        pcm = bytearray(BLOCK_SIZE)
+                    if expected is not None and block > expected:
+                        gap = block - expected
+                        lost += gap
+                        print(f"capture: {gap} blocks dropped ({dropped} since boot)",
+                              file=sys.stderr)
+                        wav.writeframes(bytes(BLOCK_SIZE * gap))
+                    wav.writeframes(pcm)
+                    blocks += 1
+                    expected = block + 1
+                    pcm.clear()
+        except KeyboardInterrupt:
+            pass
+
+    print(f"capture: {blocks} blocks recorded, {lost} dropped", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Upload a wavetable to the synthesizer over its USB serial port.
+
+The wavetable is a WAV file, or raw little-endian 16-bit samples, of a single
+period whose length is a power of two, up to 1024 samples. Only the first
+channel of a WAV file is used:
+
+    scripts/upload_wavetable.py /dev/ttyACM0 organ.wav --slot 1 --osc1
+
+The firmware answers with a line on the console once the table is loaded.
+"""
+
+import argparse
+import pathlib
+import struct
+import sys
+import wave
+import zlib
+
+SYNC = 0xA5
+FRAME_WAVETABLE_BEGIN = 0x02
+FRAME_WAVETABLE_DATA = 0x03
+FRAME_WAVETABLE_COMMIT = 0x04
+
+MAX_LENGTH = 1024
+# Samples per DATA frame, within the 255-byte payload.
+SAMPLES_PER_FRAME = 126
+
+
+def frame(frame_type, payload):
+    checksum = -(frame_type + len(payload) + sum(payload)) & 0xFF
+    return bytes([SYNC, frame_type, len(payload)]) + payload + bytes([checksum])
+
+
+def read_samples(path):
+    if path.suffix.lower() != ".wav":
+        data = path.read_bytes()
+        return list(struct.unpack(f"<{len(data) // 2}h", data[: len(data) // 2 * 2]))
+
+    with wave.open(str(path), "rb") as wav:
+        if wav.getsampwidth() != 2:
+            sys.exit(f"{path}: only 16-bit WAV files are supported")
+        channels = wav.getnchannels()
+        frames = wav.readframes(wav.getnframes())
+
+    samples = struct.unpack(f"<{len(frames) // 2}h", frames)
+    return list(samples[::channels])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", type=pathlib.Path, help="USB serial port")
+    parser.add_argument("table", type=pathlib.Path, help="WAV or raw wavetable")
+    parser.add_argument("--slot", type=int, default=0, help="wavetable slot (0)")
+    parser.add_argument("--osc1", action="store_true", help="play it on OSC1")
+    parser.add_argument("--osc2", action="store_true", help="play it on OSC2")
+    args = parser.parse_args()
+
+    samples = read_samples(args.table)
+    length = len(samples)
+    if length < 2 or length > MAX_LENGTH or length & (length - 1):
+        sys.exit(f"{args.table}: {length} samples, expected a power of two up to {MAX_LENGTH}")
+
+    data = struct.pack(f"<{length}h", *samples)
+    frames = [frame(FRAME_WAVETABLE_BEGIN,
+                    struct.pack("<BHI", args.slot, length, zlib.crc32(data)))]
+    for offset in range(0, length, SAMPLES_PER_FRAME):
+        chunk = data[offset * 2:(offset + SAMPLES_PER_FRAME) * 2]
+        frames.append(frame(FRAME_WAVETABLE_DATA, struct.pack("<H", offset) + chunk))
+    oscillators = (1 if args.osc1 else 0) | (2 if args.osc2 else 0)
+    frames.append(frame(FRAME_WAVETABLE_COMMIT, bytes([oscillators])))
+
+    with open(args.port, "wb", buffering=0) as port:
+        for f in frames:
+            port.write(f)
+
+
+if __name__ == "__main__":
+    main()
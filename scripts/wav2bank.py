@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Convert a PCM WAV file into a sample bank linked into the firmware.
+
+The bank is written as a C source file, to be placed in src/banks/ where the
+build picks it up:
+
+    scripts/wav2bank.py kick.wav -o src/banks/kick.c --root-note 36
+
+Multichannel files are mixed down to mono. The data is framed by guard
+samples, one before and two after, so the firmware can interpolate without
+checking the bounds.
+"""
+
+import argparse
+import pathlib
+import re
+import sys
+import wave
+
+VALUES_PER_LINE = 12
+
+
+def read_mono(path):
+    with wave.open(str(path), "rb") as wav:
+        if wav.getcomptype() != "NONE":
+            sys.exit(f"{path}: only uncompressed PCM is supported")
+
+        width = wav.getsampwidth()
+        channels = wav.getnchannels()
+        rate = wav.getframerate()
+        frames = wav.readframes(wav.getnframes())
+
+    def sample(offset):
+        raw = frames[offset:offset + width]
+        if width == 1:
+            # 8-bit WAV samples are unsigned.
+            return (raw[0] - 128) << 8
+        # Keep the 16 most significant bits.
+        return int.from_bytes(raw[-2:], "little", signed=True)
+
+    if width not in (1, 2, 3, 4):
+        sys.exit(f"{path}: unsupported sample width of {width} bytes")
+
+    frame_size = width * channels
+    samples = []
+    for offset in range(0, len(frames) - frame_size + 1, frame_size):
+        total = sum(sample(offset + i * width) for i in range(channels))
+        samples.append(int(round(total / channels)))
+
+    return samples, rate
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("wav", type=pathlib.Path, help="input WAV file")
+    parser.add_argument("-o", "--output", type=pathlib.Path,
+                        help="output C file, standard output by default")
+    parser.add_argument("--name", help="bank name, the file name by default")
+    parser.add_argument("--root-note", type=int, default=60,
+                        help="MIDI note the sample plays at its own rate (60)")
+    parser.add_argument("--loop-start", type=int,
+                        help="first sample of the loop, one-shot if omitted")
+    parser.add_argument("--loop-end", type=int,
+                        help="sample after the loop, where the data is cut")
+    args = parser.parse_args()
+
+    samples, rate = read_mono(args.wav)
+    if args.loop_end is not None:
+        samples = samples[:args.loop_end]
+    if not samples:
+        sys.exit(f"{args.wav}: no samples")
+
+    loop_start = len(samples) if args.loop_start is None else args.loop_start
+    if not 0 <= loop_start <= len(samples):
+        sys.exit(f"loop start {loop_start} is out of the {len(samples)} samples")
+    if not 0 <= args.root_note <= 127:
+        sys.exit(f"root note {args.root_note} is not a MIDI note")
+
+    name = args.name or args.wav.stem
+    name = re.sub(r"\W", "_", name)
+    if name[0].isdigit():
+        name = "_" + name
+
+    # One guard sample before the data, and two after it: the start of the
+    # loop, or silence for one-shot samples.
+    if loop_start < len(samples):
+        loop = samples[loop_start:] * 2
+        data = [samples[0]] + samples + loop[:2]
+    else:
+        data = [samples[0]] + samples + [0, 0]
+
+    lines = [
+        f"/* Generated by scripts/wav2bank.py from {args.wav.name}, do not edit. */",
+        "",
+        "#include <stdint.h>",
+        "",
+        '#include "../Synthesizer/sample_bank.h"',
+        "",
+        f"static const int16_t {name}_data[] = {{",
+    ]
+    for i in range(0, len(data), VALUES_PER_LINE):
+        values = ", ".join(str(value) for value in data[i:i + VALUES_PER_LINE])
+        lines.append(f"    {values},")
+    lines += [
+        "};",
+        "",
+        f"SAMPLE_BANK_DEFINE({name}, {name}_data, {loop_start}, {rate}, {args.root_note});",
+        "",
+    ]
+
+    text = "\n".join(lines)
+    if args.output is None:
+        sys.stdout.write(text)
+    else:
+        args.output.write_text(text)
+
+
+if __name__ == "__main__":
+    main()
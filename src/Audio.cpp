@@ -16,12 +16,15 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/logging/log_core.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/sys/time_units.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/sys_clock.h>
 
 #include <cstdint>
 
+#include "Capture.hpp"
+
 LOG_MODULE_REGISTER(audio, LOG_LEVEL_INF);
 
 int16_t *Audio::current_block;
@@ -29,6 +32,12 @@ const struct device *Audio::codec_dev;
 const struct device *Audio::i2s_dev;
 struct k_mem_slab Audio::mem_slab;
 int16_t Audio::mem_slab_buffer[][SAMPLES_PER_BLOCK];
+bool Audio::is_silent[];
+atomic_t Audio::target_volume;
+// The codec comes out of reset at 0 dB.
+atomic_t Audio::codec_volume = ATOMIC_INIT(UINT8_MAX);
+atomic_t Audio::last_volume_update;
+struct k_work_delayable Audio::volume_work;
 
 int Audio::init(const struct device *const codec_dev, const struct device *const i2s_dev) {
     int ret;
@@ -57,6 +66,8 @@ int Audio::init(const struct device *const codec_dev, const struct device *const
     Audio::codec_dev = codec_dev;
     Audio::i2s_dev   = i2s_dev;
 
+    k_work_init_delayable(&volume_work, [](struct k_work* const item) { update_volume(); });
+
     const struct i2s_config i2s_config = {
         .word_size      = 16,  // NOTE: Each sample is int16_t
         .channels       = CHANNEL_COUNT,
@@ -86,25 +97,51 @@ int Audio::init(const struct device *const codec_dev, const struct device *const
 }
 
 int Audio::set_volume(const uint8_t volume) {
-    int ret;
-
     audio_property_value_t value = {.vol = volume};
 
-    ret = audio_codec_set_property(codec_dev, AUDIO_PROPERTY_OUTPUT_VOLUME,
-                                   AUDIO_CHANNEL_SIDE_LEFT, value);
+    // NOTE: Both channels are written in a single burst.
+    const int ret = audio_codec_set_property(codec_dev, AUDIO_PROPERTY_OUTPUT_VOLUME,
+                                             AUDIO_CHANNEL_ALL, value);
     if (ret < 0) {
-        LOG_ERR("Failed to set right channel volume: %d", -ret);
+        LOG_ERR("Failed to set volume: %d", -ret);
         return ret;
     }
 
-    ret = audio_codec_set_property(codec_dev, AUDIO_PROPERTY_OUTPUT_VOLUME,
-                                   AUDIO_CHANNEL_SIDE_RIGHT, value);
-    if (ret < 0) {
-        LOG_ERR("Failed to set right channel volume: %d", -ret);
-        return ret;
+    return 0;
+}
+
+void Audio::update_volume(void) {
+    const uint8_t volume = atomic_get(&target_volume);
+    if (volume == atomic_get(&codec_volume)) {
+        return;
     }
 
-    return 0;
+    (void)atomic_set(&last_volume_update, k_uptime_get_32());
+    if (set_volume(volume) < 0) {
+        return;
+    }
+    (void)atomic_set(&codec_volume, volume);
+
+    // Catch up with changes posted during the write.
+    if (atomic_get(&target_volume) != volume) {
+        (void)k_work_schedule(&volume_work, K_MSEC(CONFIG_SYNTH_VOLUME_UPDATE_MS));
+    }
+}
+
+void Audio::set_volume_async(const uint8_t volume) {
+    (void)atomic_set(&target_volume, volume);
+
+    // Milliseconds, wrapping around after 49 days like the timestamp.
+    const int64_t elapsed = (uint32_t)(k_uptime_get_32() - atomic_get(&last_volume_update));
+    const int64_t delay   = CLAMP(CONFIG_SYNTH_VOLUME_UPDATE_MS - elapsed, 0,
+                                  CONFIG_SYNTH_VOLUME_UPDATE_MS);
+
+    // No-op while an update is pending, which then picks up this volume.
+    (void)k_work_schedule(&volume_work, K_MSEC(delay));
+}
+
+uint8_t Audio::get_codec_volume(void) {
+    return atomic_get(&codec_volume);
 }
 
 int16_t *Audio::get_block(const k_timeout_t timeout) {
@@ -120,8 +157,22 @@ int16_t *Audio::get_block(const k_timeout_t timeout) {
     return current_block;
 }
 
+unsigned int Audio::block_index(void) {
+    return (current_block - mem_slab_buffer[0]) / SAMPLES_PER_BLOCK;
+}
+
 void Audio::clear_block(void) {
+    const unsigned int index = block_index();
+    if (is_silent[index]) {
+        return;
+    }
+
     (void)memset(current_block, 0, sizeof(mem_slab_buffer[0]));
+    is_silent[index] = true;
+}
+
+void Audio::touch_block(void) {
+    is_silent[block_index()] = false;
 }
 
 int Audio::write_block(void) {
@@ -145,6 +196,11 @@ int Audio::write_block(void) {
         return 0;
     }
 
+#ifdef CONFIG_SYNTH_CAPTURE
+    // The DMA only reads the block, copying it out meanwhile is safe.
+    Capture::tap(current_block);
+#endif  // CONFIG_SYNTH_CAPTURE
+
     return 0;
 }
 
@@ -157,5 +213,24 @@ int Audio::start_writes(void) {
         return ret;
     }
 
+    // NOTE: The codec powers up once the I2S master clock runs and unmutes
+    // through its soft ramp.
+    audio_codec_start_output(codec_dev);
+
+    return 0;
+}
+
+int Audio::stop_writes(void) {
+    int ret;
+
+    // Mute and power the codec down while the master clock still runs.
+    audio_codec_stop_output(codec_dev);
+
+    ret = i2s_trigger(i2s_dev, I2S_DIR_TX, I2S_TRIGGER_DROP);
+    if (ret < 0) {
+        LOG_ERR("Failed to stop I2S: %d", -ret);
+        return ret;
+    }
+
     return 0;
 }
@@ -3,6 +3,7 @@
 #include <sys/cdefs.h>
 #include <zephyr/device.h>
 #include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/sys_clock.h>
 
 #include <cstdint>
@@ -12,6 +13,15 @@ class Audio {
     static const struct device* codec_dev;
     static const struct device* i2s_dev;
     static int16_t* current_block;
+    static atomic_t target_volume;
+    static atomic_t codec_volume;
+    // Uptime of the last codec write in ms, written by the worker and read by
+    // the threads posting volume changes.
+    static atomic_t last_volume_update;
+    static struct k_work_delayable volume_work;
+
+    static void update_volume(void);
+    static unsigned int block_index(void);
 
    public:
     // Double buffered.
@@ -39,23 +49,46 @@ class Audio {
     /// @return 0 on success, -ERRNO otherwise
     static int set_volume(uint8_t volume);
 
+    /// @brief Set the output volume from a background worker
+    /// Calls made while an update is pending are coalesced, and the codec is
+    /// written at most once every CONFIG_SYNTH_VOLUME_UPDATE_MS.
+    /// @param volume volume value, from 0 to 255
+    static void set_volume_async(uint8_t volume);
+
+    /// @brief Get the volume the codec was last set to
+    /// @return volume value, from 0 to 255
+    static uint8_t get_codec_volume(void);
+
     /// @brief Get an audio block to write data to
     /// @param timeout timeout for allocation
     /// @return buffer pointer on success, nullptr otherwise
     static int16_t* get_block(k_timeout_t timeout);
 
     /// @brief Clear the current block.
+    /// Blocks which were cleared last time they were used are left as they are.
     static void clear_block(void);
 
+    /// @brief Flag the current block as about to hold sound.
+    /// Call before writing to a block, so that clear_block() clears it again.
+    static void touch_block(void);
+
     /// @brief Write the previously requested block.
     /// @return 0 on success, -ERRNO otherwise
     static int write_block(void);
 
-    /// @brief Trigger start the queued writes.
+    /// @brief Trigger start the queued writes and power the codec output up.
     /// @return 0 on success, -ERRNO otherwise
     static int start_writes(void);
 
+    /// @brief Power the codec output down and drop the queued writes.
+    /// Queue blocks again before calling start_writes() to resume.
+    /// @return 0 on success, -ERRNO otherwise
+    static int stop_writes(void);
+
    private:
     static struct k_mem_slab mem_slab;
+    // NOTE: Must stay in SRAM, the CCM is out of the DMA's reach.
     static int16_t __aligned(4) mem_slab_buffer[BLOCK_COUNT][SAMPLES_PER_BLOCK];
+    // Whether each block of the slab is known to hold silence.
+    static bool is_silent[BLOCK_COUNT];
 };
@@ -0,0 +1,207 @@
+#include "Benchmark.hpp"
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_core.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/sys_clock.h>
+#include <zephyr/timing/timing.h>
+
+#include <cstdint>
+
+#include "Audio.hpp"
+#include "KeyPress.hpp"
+#include "Preset.hpp"
+#include "Synthesizer.hpp"
+#include "Synthesizer/Key.hpp"
+#include "Synthesizer/Noise.hpp"
+#include "Synthesizer/Oscillator.hpp"
+
+LOG_MODULE_REGISTER(benchmark, LOG_LEVEL_INF);
+
+// Each kernel renders as many samples as a mono audio block holds.
+constexpr unsigned int FRAME_COUNT = Audio::SAMPLES_PER_BLOCK / Audio::CHANNEL_COUNT;
+
+// Keys played by the benchmarks, one per voice.
+constexpr char KEYS[] = "awsedftgyhujkolp;";
+
+// Keeps the compiler from optimizing the measured kernels away.
+static volatile int32_t sink;
+
+// Output of the noise kernel, too large for the stack.
+static int16_t __aligned(4) noise[ROUND_UP(FRAME_COUNT, 2)];
+
+// Output of the mixer, away from the audio blocks the DMA is playing.
+static int16_t mixer_block[Audio::SAMPLES_PER_BLOCK];
+
+// Keys played by the mixer, away from the live ones.
+static KeyPress mixer_keys[MAX_KEYPRESSES];
+
+static void report(const char* const name, const uint64_t cycles, const unsigned int samples) {
+    const uint64_t centicycles = cycles * 100 / samples;
+
+    LOG_INF("%-16s %10u cycles, %6u.%02u cycles/sample, %8u ns", name, (uint32_t)cycles,
+            (uint32_t)(centicycles / 100), (uint32_t)(centicycles % 100),
+            (uint32_t)timing_cycles_to_ns(cycles));
+}
+
+static uint64_t bench_oscillator(Oscillator& osc) {
+    int32_t acc    = 0;
+    uint16_t phase = 0;
+
+    timing_t start = timing_counter_get();
+    for (unsigned int i = 0; i < FRAME_COUNT; ++i) {
+        acc += osc.compute_sample(phase, phase);
+        phase += 653;  // A4 at 44.1 kHz
+    }
+    timing_t end = timing_counter_get();
+
+    sink = acc;
+    return timing_cycles_get(&start, &end);
+}
+
+static uint64_t bench_voice(const uint8_t unison) {
+    KeyPress keypress;
+    Synthesizer::Voice voice;
+    int32_t frame[Audio::CHANNEL_COUNT] = {};
+
+    // Both oscillators mixed, whatever the live voice mode.
+    (void)Key::from_midi(69, &keypress.k);
+    Synthesizer::prepare_voice(keypress, Synthesizer::DUAL, unison,
+                               Synthesizer::MAX_DETUNE / 2, &voice);
+
+    timing_t start = timing_counter_get();
+    for (unsigned int i = 0; i < FRAME_COUNT; ++i) {
+        Synthesizer::render_voice(voice, i, frame);
+    }
+    timing_t end = timing_counter_get();
+
+    sink = frame[0] + frame[1];
+    return timing_cycles_get(&start, &end);
+}
+
+static uint64_t bench_noise(void) {
+    timing_t start = timing_counter_get();
+    Noise::fill(noise, FRAME_COUNT);
+    timing_t end = timing_counter_get();
+
+    sink = noise[FRAME_COUNT - 1];
+    return timing_cycles_get(&start, &end);
+}
+
+static uint64_t bench_key_table(void) {
+    uint32_t acc = 0;
+
+    timing_t start = timing_counter_get();
+    for (unsigned int i = 0; i < FRAME_COUNT; ++i) {
+        Key key;
+        if (Key::from_char(KEYS[i % (sizeof(KEYS) - 1)], 0, &key) == 0) {
+            acc += key.phase_increment();
+        }
+    }
+    timing_t end = timing_counter_get();
+
+    sink = acc;
+    return timing_cycles_get(&start, &end);
+}
+
+static uint64_t bench_mixer(const Preset& preset, const unsigned int voices,
+                            const unsigned int blocks) {
+    uint64_t cycles = 0;
+
+    for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
+        mixer_keys[i] = KeyPress();
+        if (i < voices) {
+            (void)Key::from_char(KEYS[i], 0, &mixer_keys[i].k);
+            mixer_keys[i].state = KeyPress::PRESSED;
+        }
+    }
+
+    for (unsigned int i = 0; i < blocks; ++i) {
+        // A block at a time, so that the audio thread renders in between. Keep
+        // other threads from inflating the count.
+        Synthesizer::begin_offline();
+        k_sched_lock();
+        timing_t start = timing_counter_get();
+        (void)Synthesizer::render_offline(mixer_block, mixer_keys, preset);
+        timing_t end = timing_counter_get();
+        k_sched_unlock();
+        Synthesizer::end_offline();
+
+        cycles += timing_cycles_get(&start, &end);
+    }
+
+    return cycles;
+}
+
+int Benchmark::run(void) {
+    char name[16];
+
+    timing_init();
+    timing_start();
+
+    LOG_INF("Benchmarking %u samples per kernel", FRAME_COUNT);
+    LOG_INF("Render code in %s, tables and voices in %s",
+            IS_ENABLED(CONFIG_SYNTH_RAMFUNC) ? "SRAM" : "flash",
+            IS_ENABLED(CONFIG_SYNTH_CCM) ? "CCM" : "flash/SRAM");
+
+    Oscillator osc;
+    for (unsigned int i = 0; i < Oscillator::WaveType::COUNT; ++i) {
+        const auto wave = osc.change_waveform(1);
+        (void)snprintk(name, sizeof(name), "oscillator/%u", (unsigned int)wave);
+        report(name, bench_oscillator(osc), FRAME_COUNT);
+    }
+
+    for (uint8_t unison = 1; unison <= MAX_UNISON; unison *= 2) {
+        (void)snprintk(name, sizeof(name), "voice/%u", unison);
+        report(name, bench_voice(unison), FRAME_COUNT);
+    }
+    report("noise", bench_noise(), FRAME_COUNT);
+    report("key-table", bench_key_table(), FRAME_COUNT);
+
+    Preset preset;
+    Synthesizer::get_preset(&preset);
+    for (unsigned int voices = 0; voices <= MAX_KEYPRESSES; ++voices) {
+        (void)snprintk(name, sizeof(name), "mixer/%u", voices);
+        // Stereo, so a block holds two samples per frame.
+        report(name, bench_mixer(preset, voices, 1), Audio::SAMPLES_PER_BLOCK);
+    }
+
+    timing_stop();
+
+    return 0;
+}
+
+void Benchmark::render(const struct shell* const sh, const unsigned int blocks) {
+    Preset live;
+
+    timing_init();
+    timing_start();
+
+    Synthesizer::get_preset(&live);
+
+    shell_print(sh, "Rendering %u blocks of %u frames per run", blocks, FRAME_COUNT);
+
+    for (uint8_t wave = 0; wave < Oscillator::WaveType::COUNT; ++wave) {
+        // Both oscillators on the waveform, mixed, without unison.
+        Preset preset      = live;
+        preset.osc[0].wave = wave;
+        preset.osc[1].wave = wave;
+        preset.voice_mode  = Synthesizer::VoiceMode::DUAL;
+        preset.unison      = 1;
+
+        for (unsigned int voices = 1; voices <= MAX_KEYPRESSES; ++voices) {
+            const uint64_t centicycles = bench_mixer(preset, voices, blocks) * 100 /
+                                         ((uint64_t)blocks * Audio::SAMPLES_PER_BLOCK);
+
+            shell_print(sh, "wave %u, %u voices: %6u.%02u cycles/sample", wave, voices,
+                        (uint32_t)(centicycles / 100), (uint32_t)(centicycles % 100));
+        }
+    }
+
+    timing_stop();
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <zephyr/shell/shell.h>
+
+class Benchmark {
+   public:
+    // Disallow creating an instance of this class.
+    Benchmark() = delete;
+
+    /// @brief Time the DSP kernels and log their cycle counts
+    /// Plays keys on the shared keypress pool, so call this function before the
+    /// synthesizer thread is started.
+    /// @return 0 on success, -ERRNO otherwise
+    static int run(void);
+
+    /// @brief Time offline renders of every waveform at every voice count
+    /// Takes the rendering over from the audio thread, which plays silence
+    /// meanwhile, and releases every key. The parameters are restored afterwards.
+    /// @param sh shell to print the cycles per sample to
+    /// @param blocks number of blocks rendered per waveform and voice count
+    static void render(const struct shell* sh, unsigned int blocks);
+};
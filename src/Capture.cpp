@@ -0,0 +1,141 @@
+#include "Capture.hpp"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/kernel/thread_stack.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/sys/util.h>
+
+#include <cstdint>
+
+#include "USB.hpp"
+#include "trace.h"
+
+// Binary frames sent to the host, in the layout of the input frames:
+//
+//     0xa5 | TYPE | LENGTH | PAYLOAD (LENGTH bytes) | CHECKSUM
+//
+// A block is sent as DATA frames in order, followed by an END frame:
+//
+//     DATA: BLOCK (LE32) | OFFSET (LE16, bytes) | PCM
+//     END:  BLOCK (LE32) | DROPPED (LE32) | CRC-32 (LE32)
+//
+// BLOCK counts every tapped block, so the host sees dropped blocks as gaps.
+constexpr uint8_t SYNC              = 0xa5;
+constexpr uint8_t FRAME_CAPTURE     = 0x10;
+constexpr uint8_t FRAME_CAPTURE_END = 0x11;
+
+constexpr unsigned int FRAME_HEADER_SIZE = 3;
+constexpr unsigned int DATA_HEADER_SIZE  = 6;
+constexpr unsigned int END_SIZE          = 12;
+
+// PCM bytes per DATA frame, whole stereo frames within the 255-byte payload.
+constexpr unsigned int CHUNK_SIZE = 248;
+
+// Ring entries are the block number followed by the block.
+constexpr unsigned int ENTRY_SIZE = sizeof(uint32_t) + Capture::BLOCK_SIZE;
+
+constexpr size_t STACK_SIZE = 1024;
+
+static_assert(DATA_HEADER_SIZE + CHUNK_SIZE <= UINT8_MAX, "DATA frames must fit LENGTH");
+static_assert(CHUNK_SIZE % (Audio::CHANNEL_COUNT * sizeof(int16_t)) == 0,
+              "DATA frames must carry whole stereo frames");
+
+K_THREAD_STACK_DEFINE(capture_stack, STACK_SIZE);
+
+// NOTE: One producer and one consumer, which the ring buffer handles without a lock.
+RING_BUF_DECLARE(capture_ring, CONFIG_SYNTH_CAPTURE_BLOCKS * ENTRY_SIZE);
+
+// Only used by the capture thread.
+static uint8_t frame[FRAME_HEADER_SIZE + UINT8_MAX + 1];
+
+struct k_thread Capture::thread;
+struct k_sem Capture::sem;
+uint32_t Capture::sequence;
+atomic_t Capture::dropped;
+
+/// @brief Send the frame whose payload is in place, waiting for room in the TX queue
+/// @param type frame type
+/// @param length payload length
+static void send_frame(const uint8_t type, const uint8_t length) {
+    uint8_t checksum = type + length;
+    for (unsigned int i = 0; i < length; ++i) {
+        checksum += frame[FRAME_HEADER_SIZE + i];
+    }
+
+    frame[0]                          = SYNC;
+    frame[1]                          = type;
+    frame[2]                          = length;
+    frame[FRAME_HEADER_SIZE + length] = -checksum;
+
+    // Bulk writes leave room for the console messages, which would fail otherwise.
+    while (USB::write_bulk(frame, FRAME_HEADER_SIZE + length + 1) == -ENOBUFS) {
+        k_msleep(1);
+    }
+}
+
+void Capture::send_block(void) {
+    uint8_t *const payload = &frame[FRAME_HEADER_SIZE];
+    uint32_t block;
+    uint32_t crc = 0;
+
+    (void)ring_buf_get(&capture_ring, reinterpret_cast<uint8_t *>(&block), sizeof(block));
+
+    for (unsigned int offset = 0; offset < BLOCK_SIZE; offset += CHUNK_SIZE) {
+        const unsigned int size = MIN(CHUNK_SIZE, BLOCK_SIZE - offset);
+
+        sys_put_le32(block, &payload[0]);
+        sys_put_le16(offset, &payload[4]);
+        (void)ring_buf_get(&capture_ring, &payload[DATA_HEADER_SIZE], size);
+        crc = crc32_ieee_update(crc, &payload[DATA_HEADER_SIZE], size);
+
+        send_frame(FRAME_CAPTURE, DATA_HEADER_SIZE + size);
+    }
+
+    sys_put_le32(block, &payload[0]);
+    sys_put_le32(get_dropped(), &payload[4]);
+    sys_put_le32(crc, &payload[8]);
+    send_frame(FRAME_CAPTURE_END, END_SIZE);
+}
+
+int Capture::init(void) {
+    k_sem_init(&sem, 0, CONFIG_SYNTH_CAPTURE_BLOCKS);
+
+    (void)k_thread_create(
+        &thread, capture_stack, K_THREAD_STACK_SIZEOF(capture_stack),
+        [](void *_a, void *_b, void *_c) {
+            while (true) {
+                (void)k_sem_take(&sem, K_FOREVER);
+                send_block();
+            }
+        },
+        nullptr, nullptr, nullptr, CONFIG_SYNTH_CAPTURE_PRIORITY, 0, K_NO_WAIT);
+    (void)k_thread_name_set(&thread, "capture");
+
+    return 0;
+}
+
+void Capture::tap(const int16_t *const block) {
+    const uint32_t block_sequence = sequence++;
+
+    if (ring_buf_space_get(&capture_ring) < ENTRY_SIZE) {
+        SYNTH_TRACE("capture_drop", block_sequence, 0);
+        (void)atomic_inc(&dropped);
+        return;
+    }
+
+    // PCM samples are little-endian in memory already.
+    (void)ring_buf_put(&capture_ring, reinterpret_cast<const uint8_t *>(&block_sequence),
+                       sizeof(block_sequence));
+    (void)ring_buf_put(&capture_ring, reinterpret_cast<const uint8_t *>(block), BLOCK_SIZE);
+    k_sem_give(&sem);
+}
+
+uint32_t Capture::get_dropped(void) {
+    return atomic_get(&dropped);
+}
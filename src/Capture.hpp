@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "Audio.hpp"
+
+class Capture {
+   public:
+    /// @brief Size of a captured block in bytes.
+    static constexpr unsigned int BLOCK_SIZE = Audio::SAMPLES_PER_BLOCK * sizeof(int16_t);
+
+   private:
+    static struct k_thread thread;
+    static struct k_sem sem;
+    static uint32_t sequence;
+    static atomic_t dropped;
+
+    static void send_block(void);
+
+   public:
+    // Disallow creating an instance of this class.
+    Capture() = delete;
+
+    /// @brief Capture initialization function
+    /// Starts the low priority thread that streams the captured blocks.
+    /// @return 0 on success, -ERRNO otherwise
+    static int init(void);
+
+    /// @brief Copy a block into the capture ring
+    /// Never blocks: the block is dropped if the ring is full. Call from the
+    /// audio thread only.
+    /// @param block interleaved stereo block of Audio::SAMPLES_PER_BLOCK samples
+    static void tap(const int16_t *block);
+
+    /// @brief Get the number of blocks dropped since boot
+    /// @return dropped block count
+    static uint32_t get_dropped(void);
+};
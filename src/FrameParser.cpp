@@ -0,0 +1,52 @@
+#include "FrameParser.hpp"
+
+#include <cstdint>
+
+FrameParser::FrameParser(void) {
+    this->reset();
+}
+
+void FrameParser::reset(void) {
+    this->state = IDLE;
+}
+
+bool FrameParser::is_idle(void) const {
+    return this->state == IDLE;
+}
+
+FrameParser::Result FrameParser::feed(const uint8_t byte) {
+    switch (this->state) {
+        case IDLE:
+            if (byte != SYNC) {
+                return PASSTHROUGH;
+            }
+            this->checksum = 0;
+            this->state    = TYPE;
+            return NONE;
+        case TYPE:
+            this->frame.type = byte;
+            this->state      = LENGTH;
+            break;
+        case LENGTH:
+            this->frame.length = byte;
+            this->received     = 0;
+            this->state        = byte == 0 ? CHECKSUM : PAYLOAD;
+            break;
+        case PAYLOAD:
+            this->frame.payload[this->received++] = byte;
+            if (this->received == this->frame.length) {
+                this->state = CHECKSUM;
+            }
+            break;
+        case CHECKSUM:
+            this->state = IDLE;
+            return (uint8_t)(this->checksum + byte) == 0 ? FRAME : CHECKSUM_ERROR;
+    }
+
+    this->checksum += byte;
+    return NONE;
+}
+
+const FrameParser::Frame& FrameParser::get_frame(void) const {
+    return this->frame;
+}
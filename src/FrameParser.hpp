@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+/// @brief Incremental parser for the framed binary protocol on the USB serial link
+/// A frame is laid out as:
+///
+///     SYNC | TYPE | LENGTH | PAYLOAD (LENGTH bytes) | CHECKSUM
+///
+/// where CHECKSUM makes the 8-bit sum of TYPE, LENGTH, PAYLOAD and CHECKSUM zero.
+/// Bytes received outside of a frame are passed through so that the ASCII keymap
+/// keeps working on the same link. Has no Zephyr dependency so it can be fed
+/// recorded streams on the host.
+class FrameParser {
+   public:
+    static constexpr uint8_t SYNC             = 0xa5;
+    static constexpr unsigned int MAX_PAYLOAD = UINT8_MAX;
+
+    struct Frame {
+        uint8_t type;
+        uint8_t length;
+        uint8_t payload[MAX_PAYLOAD];
+    };
+
+    typedef enum {
+        /// The byte was consumed, no frame is complete yet.
+        NONE,
+        /// A valid frame is available through get_frame().
+        FRAME,
+        /// The byte is not part of a frame.
+        PASSTHROUGH,
+        /// A frame was received but dropped due to a checksum mismatch.
+        CHECKSUM_ERROR,
+    } Result;
+
+   private:
+    enum {
+        IDLE,
+        TYPE,
+        LENGTH,
+        PAYLOAD,
+        CHECKSUM,
+    } state;
+    uint8_t checksum;
+    uint8_t received;
+    Frame frame;
+
+   public:
+    FrameParser(void);
+
+    /// @brief Drop any partially received frame.
+    void reset(void);
+
+    /// @brief Check whether the parser is in between frames
+    /// @return true if no frame is partially received
+    bool is_idle(void) const;
+
+    /// @brief Feed the next byte of the stream to the parser
+    /// @param byte received byte
+    /// @return parsing result
+    Result feed(uint8_t byte);
+
+    /// @brief Get the last complete frame
+    /// Only valid after feed() returned FRAME and until the next call to feed().
+    /// @return the frame
+    const Frame& get_frame(void) const;
+};
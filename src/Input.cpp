@@ -0,0 +1,200 @@
+#include "Input.hpp"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/kernel/thread_stack.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_core.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include "RotaryEncoder.hpp"
+#include "Switch.hpp"
+#include "trace.h"
+
+LOG_MODULE_REGISTER(input, LOG_LEVEL_INF);
+
+K_THREAD_STACK_DEFINE(input_stack, CONFIG_SYNTH_INPUT_WORKQ_STACK_SIZE);
+
+struct k_work_q Input::queue;
+const struct device* Input::expander;
+RotaryEncoder* Input::encoders;
+size_t Input::encoder_count;
+Switch* Input::switches;
+size_t Input::switch_count;
+Input::Handler Input::handler;
+gpio_port_pins_t Input::encoder_pins;
+gpio_port_value_t Input::snapshot;
+struct gpio_callback Input::expander_cb;
+struct k_work Input::sample_work;
+struct k_work Input::scan_work;
+struct k_timer Input::scan_timer;
+atomic_t Input::edge_seen;
+atomic_t Input::sample_pending;
+
+void Input::on_edge(const struct device* dev, struct gpio_callback* cb,
+                    gpio_port_pins_t pins) {
+    (void)atomic_set(&edge_seen, 1);
+
+    // Edges arriving while the sample is pending are covered by it.
+    if (cb == &expander_cb) {
+        (void)atomic_set(&sample_pending, 1);
+        (void)k_work_submit_to_queue(&queue, &sample_work);
+    }
+
+    if (k_timer_remaining_ticks(&scan_timer) == 0) {
+        k_timer_start(&scan_timer, K_MSEC(CONFIG_SYNTH_INPUT_SCAN_MS),
+                      K_MSEC(CONFIG_SYNTH_INPUT_SCAN_MS));
+    }
+}
+
+void Input::sample_encoders(void) {
+    gpio_port_value_t value;
+
+    // Whichever of the sample work and the scan runs first reads the port for
+    // both. Cleared before the read, so that an edge during it is read again.
+    if (!atomic_clear(&sample_pending)) {
+        return;
+    }
+
+    // NOTE: A single transfer reads every pin of the expander.
+    const int ret = gpio_port_get(expander, &value);
+    if (ret < 0) {
+        LOG_ERR("Failed to read the expander port: %d", -ret);
+        // Retried by the next scan.
+        (void)atomic_set(&sample_pending, 1);
+        return;
+    }
+
+    const gpio_port_pins_t changed = (value ^ snapshot) & encoder_pins;
+    snapshot                       = value;
+    SYNTH_TRACE("input_scan", value, changed);
+
+    for (size_t i = 0; i < encoder_count; ++i) {
+        if (changed & encoders[i].get_pin_mask()) {
+            (void)encoders[i].update(value);
+        }
+    }
+}
+
+void Input::scan(void) {
+    const bool had_edges = atomic_clear(&edge_seen);
+
+    // Catch up on encoder edges whose sample work has not run yet. Costs no
+    // I2C transfer when every edge has been sampled already.
+    sample_encoders();
+
+    Events events   = {};
+    bool has_events = false;
+    bool is_settled = true;
+    for (size_t i = 0; i < encoder_count; ++i) {
+        events.encoder_deltas[i] = encoders[i].take_steps();
+        has_events |= events.encoder_deltas[i] != 0;
+    }
+
+    for (size_t i = 0; i < switch_count; ++i) {
+        if (switches[i].debounce()) {
+            events.changed_switches |= BIT(i);
+            has_events = true;
+        }
+        events.switch_states[i] = switches[i].get_state();
+        is_settled &= switches[i].is_settled();
+    }
+
+    if (has_events) {
+        handler(events);
+    }
+
+    // Keep scanning while anything moves. An edge racing with the stop
+    // restarts the timer either here or from its own callback.
+    if (is_settled && !has_events && !had_edges) {
+        k_timer_stop(&scan_timer);
+        if (atomic_get(&edge_seen)) {
+            k_timer_start(&scan_timer, K_MSEC(CONFIG_SYNTH_INPUT_SCAN_MS),
+                          K_MSEC(CONFIG_SYNTH_INPUT_SCAN_MS));
+        }
+    }
+}
+
+int Input::init(RotaryEncoder* const encoders, const size_t encoder_count,
+                Switch* const switches, const size_t switch_count, const Handler handler) {
+    int ret;
+
+    if (encoders == nullptr || encoder_count == 0 || encoder_count > MAX_ENCODERS) {
+        LOG_ERR("Invalid encoder count: %u", encoder_count);
+        return -EINVAL;
+    }
+
+    if (switch_count > MAX_SWITCHES || handler == nullptr) {
+        LOG_ERR("Invalid switches or handler");
+        return -EINVAL;
+    }
+
+    Input::expander      = encoders[0].get_port();
+    Input::encoders      = encoders;
+    Input::encoder_count = encoder_count;
+    Input::switches      = switches;
+    Input::switch_count  = switch_count;
+    Input::handler       = handler;
+    Input::encoder_pins  = 0;
+
+    const struct k_work_queue_config queue_config = {
+        .name     = "input",
+        .no_yield = false,
+    };
+    k_work_queue_start(&queue, input_stack, K_THREAD_STACK_SIZEOF(input_stack),
+                       CONFIG_SYNTH_INPUT_WORKQ_PRIORITY, &queue_config);
+
+    k_work_init(&sample_work, [](struct k_work* const item) { sample_encoders(); });
+    k_work_init(&scan_work, [](struct k_work* const item) { scan(); });
+    k_timer_init(
+        &scan_timer,
+        [](struct k_timer* const timer) { (void)k_work_submit_to_queue(&queue, &scan_work); },
+        nullptr);
+
+    for (size_t i = 0; i < encoder_count; ++i) {
+        if (encoders[i].get_port() != expander) {
+            LOG_ERR("Encoder %u is not on the expander", i);
+            return -EINVAL;
+        }
+
+        ret = encoders[i].init();
+        if (ret < 0) {
+            LOG_ERR("Failed to initialize encoder %u: %d", i, -ret);
+            return ret;
+        }
+
+        encoder_pins |= encoders[i].get_pin_mask();
+    }
+
+    ret = gpio_port_get(expander, &snapshot);
+    if (ret < 0) {
+        LOG_ERR("Failed to read the expander port: %d", -ret);
+        return ret;
+    }
+
+    for (size_t i = 0; i < encoder_count; ++i) {
+        encoders[i].reset(snapshot);
+    }
+
+    gpio_init_callback(&expander_cb, on_edge, encoder_pins);
+    ret = gpio_add_callback(expander, &expander_cb);
+    if (ret < 0) {
+        LOG_ERR("Could not add callback to the expander: %d", -ret);
+        return ret;
+    }
+
+    for (size_t i = 0; i < switch_count; ++i) {
+        ret = switches[i].init(on_edge);
+        if (ret < 0) {
+            LOG_ERR("Failed to initialize switch %u: %d", i, -ret);
+            return ret;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "RotaryEncoder.hpp"
+#include "Switch.hpp"
+
+class Input {
+   public:
+    static constexpr size_t MAX_ENCODERS = 8;
+    static constexpr size_t MAX_SWITCHES = 8;
+
+    /// @brief Control changes gathered by a single scan
+    struct Events {
+        // Accumulated steps of every encoder, 0 when it did not move.
+        int32_t encoder_deltas[MAX_ENCODERS];
+        // Debounced state of every switch.
+        Switch::State switch_states[MAX_SWITCHES];
+        // Bit i is set if switch i changed its state.
+        uint32_t changed_switches;
+    };
+
+    // Called from the input workqueue with the changes of a scan.
+    typedef void (*Handler)(const Events& events);
+
+   private:
+    static struct k_work_q queue;
+    static const struct device* expander;
+    static RotaryEncoder* encoders;
+    static size_t encoder_count;
+    static Switch* switches;
+    static size_t switch_count;
+    static Handler handler;
+    static gpio_port_pins_t encoder_pins;
+    static gpio_port_value_t snapshot;
+    static struct gpio_callback expander_cb;
+    static struct k_work sample_work;
+    static struct k_work scan_work;
+    static struct k_timer scan_timer;
+    static atomic_t edge_seen;
+    // Set by expander edges, cleared when the expander port is read.
+    static atomic_t sample_pending;
+
+    static void on_edge(const struct device* dev, struct gpio_callback* cb,
+                        gpio_port_pins_t pins);
+    static void sample_encoders(void);
+    static void scan(void);
+
+   public:
+    // Disallow creating an instance of this class.
+    Input() = delete;
+
+    /// @brief Input subsystem initialization function
+    /// All control work runs on a dedicated workqueue. Every encoder must sit on
+    /// the same port expander, whose port is read in a single transfer on each
+    /// of its edges so that no encoder step is missed. Any control edge also
+    /// starts a periodic scan, which debounces the switches and hands the
+    /// changes of every control to @p handler in one batch. The scan stops
+    /// once every control has settled.
+    /// @param encoders encoders to scan
+    /// @param encoder_count number of encoders, up to MAX_ENCODERS
+    /// @param switches switches to scan
+    /// @param switch_count number of switches, up to MAX_SWITCHES
+    /// @param handler handler for the changes of each scan
+    /// @return 0 on success, -ERRNO otherwise
+    static int init(RotaryEncoder* encoders, size_t encoder_count, Switch* switches,
+                    size_t switch_count, Handler handler);
+};
@@ -4,12 +4,17 @@
 #include <zephyr/sys_clock.h>
 
 #include "Synthesizer/Key.hpp"
+#include "placement.h"
 
-KeyPress keypresses[MAX_KEYPRESSES];
+KeyPress keypresses[MAX_KEYPRESSES] SYNTH_VOICE_STATE;
 
 KeyPress::KeyPress(void)
-    : k{Key::A3},
+    : k{},
       state{IDLE},
       hold_time{sys_timepoint_calc(K_FOREVER)},
       release_time{sys_timepoint_calc(K_FOREVER)},
-      phase{0, 0} {}
+      phase{0, 0},
+      unison_phase{},
+      sample_position{0},
+      bank{nullptr},
+      velocity{MAX_VELOCITY} {}
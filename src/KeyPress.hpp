@@ -5,17 +5,32 @@
 #include <zephyr/sys_clock.h>
 
 #include "Synthesizer/Key.hpp"
+#include "Synthesizer/sample_bank.h"
 
 /// @brief Maximum number of keys. Space allocated at compile time.
 constexpr uint8_t MAX_KEYPRESSES = 4;
 
+/// @brief Maximum number of detuned copies of a unison voice.
+constexpr uint8_t MAX_UNISON = 8;
+
+/// @brief Velocity of a key played at full strength, as in MIDI.
+constexpr uint8_t MAX_VELOCITY = 127;
+
 class KeyPress {
    public:
     Key k;
     enum { IDLE, PRESSED, RELEASED } state;
     k_timepoint_t hold_time;
     k_timepoint_t release_time;
-    uint16_t phase[2];
+    // Per-oscillator phase, a full period spanning the whole 32-bit range.
+    uint32_t phase[2];
+    // Phase of each OSC1 copy of a unison voice.
+    uint32_t unison_phase[MAX_UNISON];
+    // Position in the sample bank, in 32.32 fixed-point samples.
+    uint64_t sample_position;
+    // Bank the position refers to.
+    const struct sample_bank *bank;
+    uint8_t velocity;
 
     KeyPress(void);
 
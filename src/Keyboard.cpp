@@ -0,0 +1,409 @@
+#include "Keyboard.hpp"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_core.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/sys_clock.h>
+
+#include <cstdint>
+
+#include "FrameParser.hpp"
+#include "KeyPress.hpp"
+#include "MidiParser.hpp"
+#include "Synthesizer.hpp"
+#include "Synthesizer/Key.hpp"
+#include "Synthesizer/Percussion.hpp"
+#include "Synthesizer/Wavetable.hpp"
+#include "Telemetry.hpp"
+#include "USB.hpp"
+
+LOG_MODULE_REGISTER(keyboard, LOG_LEVEL_INF);
+
+#ifdef CONFIG_SYNTH_INPUT_MIDI
+constexpr uint8_t CC_VOLUME        = 7;
+constexpr uint8_t CC_ALL_SOUND_OFF = 120;
+constexpr uint8_t CC_ALL_NOTES_OFF = 123;
+
+// General MIDI percussion channel (10) and the notes of its sounds.
+constexpr uint8_t PERCUSSION_CHANNEL = 9;
+constexpr uint8_t NOTE_KICK          = 36;
+constexpr uint8_t NOTE_SNARE         = 38;
+constexpr uint8_t NOTE_HIHAT         = 42;
+
+static void handle_percussion(const MidiParser::Event& event) {
+    if (event.type != MidiParser::Event::NOTE_ON) {
+        return;
+    }
+
+    switch (event.data1) {
+        case NOTE_KICK:
+            (void)Synthesizer::hit(Percussion::Sound::KICK, event.data2);
+            break;
+        case NOTE_SNARE:
+            (void)Synthesizer::hit(Percussion::Sound::SNARE, event.data2);
+            break;
+        case NOTE_HIHAT:
+            (void)Synthesizer::hit(Percussion::Sound::HIHAT, event.data2);
+            break;
+        default:
+            LOG_DBG("Percussion note %u is not mapped", event.data1);
+            break;
+    }
+}
+
+static MidiParser parser;
+
+static void handle_midi(const MidiParser::Event& event) {
+    Key key;
+
+    if (event.channel == PERCUSSION_CHANNEL) {
+        handle_percussion(event);
+        return;
+    }
+
+    switch (event.type) {
+        case MidiParser::Event::NOTE_ON:
+            if (Key::from_midi(event.data1, &key) < 0) {
+                LOG_DBG("Note %u out of range", event.data1);
+                return;
+            }
+            (void)Synthesizer::note_on(key, event.data2, K_FOREVER);
+            break;
+        case MidiParser::Event::NOTE_OFF:
+            if (Key::from_midi(event.data1, &key) < 0) {
+                return;
+            }
+            Synthesizer::note_off(key);
+            break;
+        case MidiParser::Event::CONTROL_CHANGE:
+            switch (event.data1) {
+                case CC_VOLUME:
+                    Synthesizer::set_master_volume(event.data2 * 2);
+                    break;
+                case CC_ALL_SOUND_OFF:
+                case CC_ALL_NOTES_OFF:
+                    Synthesizer::all_notes_off();
+                    break;
+                default:
+                    LOG_DBG("Ignored controller %u", event.data1);
+                    break;
+            }
+            break;
+        case MidiParser::Event::PITCH_BEND:
+            Synthesizer::set_pitch_bend(event.bend());
+            break;
+    }
+}
+#else
+// Binary frame types.
+constexpr uint8_t FRAME_EVENTS           = 0x01;
+constexpr uint8_t FRAME_WAVETABLE_BEGIN  = 0x02;
+constexpr uint8_t FRAME_WAVETABLE_DATA   = 0x03;
+constexpr uint8_t FRAME_WAVETABLE_COMMIT = 0x04;
+
+// A wavetable upload is a BEGIN frame, DATA frames in order and a COMMIT frame:
+//
+//     BEGIN:  SLOT | LENGTH (LE16, samples) | CRC-32 (LE32)
+//     DATA:   OFFSET (LE16, samples) | SAMPLES (LE16 each)
+//     COMMIT: OSCILLATORS (bit 0: OSC1, bit 1: OSC2)
+//
+// The committed table is played by the oscillators set in OSCILLATORS, and by
+// those already playing the slot.
+constexpr unsigned int WAVETABLE_BEGIN_SIZE  = 7;
+constexpr unsigned int WAVETABLE_COMMIT_SIZE = 1;
+
+// An EVENTS frame carries a batch of events laid out as:
+//
+//     KIND | DATA | VALUE (LE16) | DELAY_MS (LE16)
+//
+// DELAY_MS is relative to the reception of the frame.
+constexpr unsigned int EVENT_SIZE = 6;
+
+typedef enum : uint8_t {
+    EVENT_NOTE_ON,   // DATA: MIDI note, VALUE: velocity
+    EVENT_NOTE_OFF,  // DATA: MIDI note
+    EVENT_PARAM,     // DATA: parameter, VALUE: parameter value
+    EVENT_HIT,       // DATA: percussion sound, VALUE: velocity
+} EventKind;
+
+typedef enum : uint8_t {
+    PARAM_MASTER_VOLUME,  // 0 to 255
+    PARAM_PITCH_BEND,     // -8192 to 8191
+    PARAM_ALL_NOTES_OFF,
+} EventParam;
+
+// Keys shifting the keymap by an octave.
+constexpr char KEY_OCTAVE_DOWN = 'z';
+constexpr char KEY_OCTAVE_UP   = 'x';
+
+// Keys playing the percussion sounds.
+constexpr char KEY_KICK  = '1';
+constexpr char KEY_SNARE = '2';
+constexpr char KEY_HIHAT = '3';
+
+// Octaves the keymap can be shifted by in either direction.
+constexpr int8_t MAX_OCTAVE_SHIFT = 4;
+
+// Gap after which a partially received frame is dropped.
+constexpr unsigned int FRAME_TIMEOUT_MS = 100;
+
+// Timestamped events waiting to be applied, two full frames' worth so that a
+// frame can arrive while the previous one plays out. Space allocated at
+// compile time.
+constexpr unsigned int MAX_PENDING_EVENTS = 2 * (FrameParser::MAX_PAYLOAD / EVENT_SIZE);
+
+struct PendingEvent {
+    k_timepoint_t due;
+    EventKind kind;
+    uint8_t data;
+    uint16_t value;
+};
+
+static FrameParser parser;
+static k_timepoint_t frame_deadline;
+// Sorted by due time, and in order of arrival among the events due at the same
+// time, so that a note-off never overtakes its note-on.
+static PendingEvent pending_events[MAX_PENDING_EVENTS];
+static unsigned int pending_count;
+static int8_t octave;
+
+static void handle_char(const char ch) {
+    Key key;
+
+    switch (ch) {
+        case KEY_OCTAVE_DOWN:
+        case KEY_OCTAVE_UP:
+            octave = CLAMP(octave + (ch == KEY_OCTAVE_UP ? 1 : -1), -MAX_OCTAVE_SHIFT,
+                           MAX_OCTAVE_SHIFT);
+            Telemetry::post(Telemetry::OCTAVE, Synthesizer::Mode::MASTER, octave);
+            break;
+        case KEY_KICK:
+        case KEY_SNARE:
+        case KEY_HIHAT:
+            (void)Synthesizer::hit(static_cast<Percussion::Sound>(ch - KEY_KICK),
+                                   MAX_VELOCITY);
+            break;
+        default:
+            if (Key::from_char(ch, octave, &key) < 0) {
+                LOG_DBG("Key %c is not mapped", ch);
+                return;
+            }
+
+            // The keymap has no note-off, so every key is held for a fixed time.
+            (void)Synthesizer::note_on(key, MAX_VELOCITY, K_MSEC(500));
+            break;
+    }
+}
+
+static void apply_event(const EventKind kind, const uint8_t data, const uint16_t value) {
+    Key key;
+
+    switch (kind) {
+        case EVENT_NOTE_ON:
+            if (Key::from_midi(data, &key) == 0) {
+                (void)Synthesizer::note_on(key, MIN(value, MAX_VELOCITY), K_FOREVER);
+            }
+            break;
+        case EVENT_NOTE_OFF:
+            if (Key::from_midi(data, &key) == 0) {
+                Synthesizer::note_off(key);
+            }
+            break;
+        case EVENT_HIT:
+            if (Synthesizer::hit(static_cast<Percussion::Sound>(data),
+                                 MIN(value, MAX_VELOCITY)) < 0) {
+                LOG_DBG("Percussion sound %u is not mapped", data);
+            }
+            break;
+        case EVENT_PARAM:
+            switch (data) {
+                case PARAM_MASTER_VOLUME:
+                    Synthesizer::set_master_volume(MIN(value, UINT8_MAX));
+                    break;
+                case PARAM_PITCH_BEND:
+                    Synthesizer::set_pitch_bend((int16_t)value);
+                    break;
+                case PARAM_ALL_NOTES_OFF:
+                    Synthesizer::all_notes_off();
+                    break;
+                default:
+                    LOG_DBG("Ignored parameter %u", data);
+                    break;
+            }
+            break;
+        default:
+            LOG_DBG("Ignored event kind %u", kind);
+            break;
+    }
+}
+
+static void schedule_event(const EventKind kind, const uint8_t data, const uint16_t value,
+                           const uint16_t delay_ms) {
+    // Events due earlier are still pending until the next apply_due_events().
+    if (delay_ms == 0 &&
+        (pending_count == 0 || !sys_timepoint_expired(pending_events[0].due))) {
+        apply_event(kind, data, value);
+        return;
+    }
+
+    if (pending_count == MAX_PENDING_EVENTS) {
+        LOG_WRN("Dropped event, too many pending");
+        return;
+    }
+
+    const k_timepoint_t due = sys_timepoint_calc(K_MSEC(delay_ms));
+
+    // Behind every event due at the same time or earlier.
+    unsigned int i = pending_count;
+    while (i > 0 && sys_timepoint_cmp(pending_events[i - 1].due, due) > 0) {
+        pending_events[i] = pending_events[i - 1];
+        --i;
+    }
+
+    pending_events[i] = {
+        .due   = due,
+        .kind  = kind,
+        .data  = data,
+        .value = value,
+    };
+    ++pending_count;
+}
+
+static void handle_events(const FrameParser::Frame& frame) {
+    if (frame.length % EVENT_SIZE != 0) {
+        LOG_WRN("Dropped events frame of length %u", frame.length);
+        return;
+    }
+
+    for (unsigned int i = 0; i < frame.length; i += EVENT_SIZE) {
+        const uint8_t* const event = &frame.payload[i];
+        schedule_event(static_cast<EventKind>(event[0]), event[1], sys_get_le16(&event[2]),
+                       sys_get_le16(&event[4]));
+    }
+}
+
+static int handle_wavetable(const FrameParser::Frame& frame) {
+    int ret;
+
+    switch (frame.type) {
+        case FRAME_WAVETABLE_BEGIN:
+            if (frame.length != WAVETABLE_BEGIN_SIZE) {
+                return -EINVAL;
+            }
+            return Wavetable::begin(frame.payload[0], sys_get_le16(&frame.payload[1]),
+                                    sys_get_le32(&frame.payload[3]));
+        case FRAME_WAVETABLE_DATA:
+            if (frame.length < sizeof(uint16_t)) {
+                return -EINVAL;
+            }
+            return Wavetable::write(sys_get_le16(&frame.payload[0]), &frame.payload[2],
+                                    frame.length - sizeof(uint16_t));
+        case FRAME_WAVETABLE_COMMIT:
+            if (frame.length != WAVETABLE_COMMIT_SIZE) {
+                return -EINVAL;
+            }
+
+            ret = Wavetable::commit();
+            if (ret < 0) {
+                return ret;
+            }
+
+            for (unsigned int mode = Synthesizer::OSC1; mode <= Synthesizer::OSC2; ++mode) {
+                if (frame.payload[0] & BIT(mode)) {
+                    Synthesizer::use_wavetable(static_cast<Synthesizer::Mode>(mode), ret);
+                }
+            }
+            // The audio thread may be powered down, and would only swap the
+            // table in at the next note, failing every upload until then.
+            Synthesizer::apply_pending();
+            USB::println("Wavetable %d loaded", ret);
+            return 0;
+        default:
+            return -EINVAL;
+    }
+}
+
+static void handle_frame(const FrameParser::Frame& frame) {
+    int ret;
+
+    switch (frame.type) {
+        case FRAME_EVENTS:
+            handle_events(frame);
+            break;
+        case FRAME_WAVETABLE_BEGIN:
+        case FRAME_WAVETABLE_DATA:
+        case FRAME_WAVETABLE_COMMIT:
+            ret = handle_wavetable(frame);
+            if (ret < 0) {
+                // Let the host know, so that it restarts the upload.
+                USB::println("Wavetable upload failed: %d", -ret);
+            }
+            break;
+        default:
+            LOG_WRN("Dropped frame of type %u and length %u", frame.type, frame.length);
+            break;
+    }
+}
+
+static k_timeout_t apply_due_events(void) {
+    unsigned int due = 0;
+
+    while (due < pending_count && sys_timepoint_expired(pending_events[due].due)) {
+        const PendingEvent& event = pending_events[due++];
+        apply_event(event.kind, event.data, event.value);
+    }
+
+    pending_count -= due;
+    (void)memmove(&pending_events[0], &pending_events[due],
+                  pending_count * sizeof(pending_events[0]));
+
+    return pending_count == 0 ? K_FOREVER : sys_timepoint_timeout(pending_events[0].due);
+}
+#endif  // CONFIG_SYNTH_INPUT_MIDI
+
+k_timeout_t Keyboard::process(void) {
+    uint8_t buffer[16];
+    uint32_t size;
+
+    while ((size = USB::read((char*)buffer, sizeof(buffer))) != 0) {
+        for (uint32_t i = 0; i < size; ++i) {
+#ifdef CONFIG_SYNTH_INPUT_MIDI
+            MidiParser::Event event;
+            if (parser.feed(buffer[i], &event)) {
+                handle_midi(event);
+            }
+#else
+            if (!parser.is_idle() && sys_timepoint_expired(frame_deadline)) {
+                LOG_WRN("Dropped incomplete frame");
+                parser.reset();
+            }
+
+            switch (parser.feed(buffer[i])) {
+                case FrameParser::NONE:
+                    frame_deadline = sys_timepoint_calc(K_MSEC(FRAME_TIMEOUT_MS));
+                    break;
+                case FrameParser::FRAME:
+                    handle_frame(parser.get_frame());
+                    break;
+                case FrameParser::PASSTHROUGH:
+                    handle_char((char)buffer[i]);
+                    break;
+                case FrameParser::CHECKSUM_ERROR:
+                    LOG_WRN("Dropped frame with a bad checksum");
+                    break;
+            }
+#endif  // CONFIG_SYNTH_INPUT_MIDI
+        }
+    }
+
+#ifdef CONFIG_SYNTH_INPUT_MIDI
+    return K_FOREVER;
+#else
+    return apply_due_events();
+#endif  // CONFIG_SYNTH_INPUT_MIDI
+}
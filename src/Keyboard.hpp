@@ -0,0 +1,16 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+
+class Keyboard {
+   public:
+    // Disallow creating an instance of this class.
+    Keyboard() = delete;
+
+    /// @brief Turn every byte received over USB into synthesizer events
+    /// The bytes are interpreted as the ASCII keymap and binary frames, or as a
+    /// MIDI stream, depending on CONFIG_SYNTH_INPUT. Timestamped events that are
+    /// due are applied as well.
+    /// @return time until the next timestamped event is due, K_FOREVER if none
+    static k_timeout_t process(void);
+};
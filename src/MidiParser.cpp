@@ -0,0 +1,116 @@
+#include "MidiParser.hpp"
+
+#include <cstdint>
+
+constexpr uint8_t STATUS_BIT = 0x80;
+
+constexpr uint8_t NOTE_OFF         = 0x80;
+constexpr uint8_t NOTE_ON          = 0x90;
+constexpr uint8_t POLY_AFTERTOUCH  = 0xa0;
+constexpr uint8_t CONTROL_CHANGE   = 0xb0;
+constexpr uint8_t PROGRAM_CHANGE   = 0xc0;
+constexpr uint8_t CHANNEL_PRESSURE = 0xd0;
+constexpr uint8_t PITCH_BEND       = 0xe0;
+constexpr uint8_t SYSEX_START      = 0xf0;
+constexpr uint8_t TIME_CODE        = 0xf1;
+constexpr uint8_t SONG_POSITION    = 0xf2;
+constexpr uint8_t SONG_SELECT      = 0xf3;
+constexpr uint8_t SYSEX_END        = 0xf7;
+constexpr uint8_t REAL_TIME_START  = 0xf8;
+
+int16_t MidiParser::Event::bend(void) const {
+    return (int16_t)(((uint16_t)this->data2 << 7) | this->data1) - 8192;
+}
+
+MidiParser::MidiParser(void) {
+    this->reset();
+}
+
+void MidiParser::reset(void) {
+    this->status         = 0;
+    this->data_count     = 0;
+    this->expected_count = 0;
+    this->in_sysex       = false;
+}
+
+bool MidiParser::feed(const uint8_t byte, Event* const event) {
+    // Real-time messages may appear anywhere, even within other messages, and
+    // leave the parser state untouched.
+    if (byte >= REAL_TIME_START) {
+        return false;
+    }
+
+    if (byte & STATUS_BIT) {
+        this->data_count = 0;
+        this->in_sysex   = byte == SYSEX_START;
+
+        switch (byte & 0xf0) {
+            case PROGRAM_CHANGE:
+            case CHANNEL_PRESSURE:
+                this->status         = byte;
+                this->expected_count = 1;
+                break;
+            case 0xf0:
+                // System messages cancel the running status. Only the data bytes
+                // of the system common ones are tracked so they can be skipped.
+                this->status         = byte;
+                this->expected_count = byte == SONG_POSITION                      ? 2
+                                       : byte == TIME_CODE || byte == SONG_SELECT ? 1
+                                                                                  : 0;
+                if (byte == SYSEX_END || this->expected_count == 0) {
+                    this->status = 0;
+                }
+                break;
+            default:
+                this->status         = byte;
+                this->expected_count = 2;
+                break;
+        }
+
+        return false;
+    }
+
+    if (this->in_sysex || this->status == 0) {
+        return false;
+    }
+
+    this->data[this->data_count++] = byte;
+    if (this->data_count < this->expected_count) {
+        return false;
+    }
+
+    // Channel messages keep the running status, so the next data bytes start a
+    // new message with the same status.
+    this->data_count = 0;
+
+    const uint8_t type = this->status & 0xf0;
+    if (type == 0xf0) {
+        this->status = 0;
+        return false;
+    }
+
+    event->channel = this->status & 0x0f;
+    event->data1   = this->data[0];
+    event->data2   = this->expected_count > 1 ? this->data[1] : 0;
+
+    switch (type) {
+        case NOTE_OFF:
+            event->type = Event::NOTE_OFF;
+            return true;
+        case NOTE_ON:
+            // A note-on with zero velocity is a note-off.
+            event->type = event->data2 == 0 ? Event::NOTE_OFF : Event::NOTE_ON;
+            return true;
+        case CONTROL_CHANGE:
+            event->type = Event::CONTROL_CHANGE;
+            return true;
+        case PITCH_BEND:
+            event->type = Event::PITCH_BEND;
+            return true;
+        case POLY_AFTERTOUCH:
+        case PROGRAM_CHANGE:
+        case CHANNEL_PRESSURE:
+        default:
+            return false;
+    }
+}
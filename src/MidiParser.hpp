@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+/// @brief Incremental, allocation-free MIDI 1.0 byte stream parser
+/// Handles running status, interleaved real-time bytes and skips system
+/// exclusive and system common messages. Has no Zephyr dependency so recorded
+/// MIDI streams can be replayed through it on the host.
+class MidiParser {
+   public:
+    struct Event {
+        enum Type : uint8_t {
+            NOTE_OFF,
+            NOTE_ON,
+            CONTROL_CHANGE,
+            PITCH_BEND,
+        } type;
+        uint8_t channel;
+
+        /// Note or controller number, LSB for pitch bend.
+        uint8_t data1;
+
+        /// Velocity or controller value, MSB for pitch bend.
+        uint8_t data2;
+
+        /// @brief Get the signed pitch bend amount of a PITCH_BEND event
+        /// @return bend from -8192 to 8191, 0 being the center
+        int16_t bend(void) const;
+    };
+
+   private:
+    uint8_t status;
+    uint8_t data[2];
+    uint8_t data_count;
+    uint8_t expected_count;
+    bool in_sysex;
+
+   public:
+    MidiParser(void);
+
+    /// @brief Forget any partially received message and the running status.
+    void reset(void);
+
+    /// @brief Feed the next byte of the stream to the parser
+    /// @param byte received byte
+    /// @param event filled in when the byte completes a supported message
+    /// @return true if event was filled in, false otherwise
+    bool feed(uint8_t byte, Event* event);
+};
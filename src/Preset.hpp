@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Synthesizer/Oscillator.hpp"
+
+/// @brief Snapshot of every synthesizer parameter, stored as is in flash
+struct Preset {
+    // Bump on any layout change. Stored presets of another version are ignored.
+    static constexpr uint8_t VERSION = 5;
+
+    uint8_t version;
+    Oscillator::Settings osc[2];
+    uint8_t master_volume;
+    // Reserved for the low-pass filter until it is implemented.
+    uint8_t filter_cutoff;
+    uint8_t filter_resonance;
+    uint8_t effect;
+    uint8_t voice_mode;
+    uint8_t mod_index;
+    uint8_t unison;
+    uint8_t detune;
+    uint8_t sample;
+};
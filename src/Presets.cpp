@@ -0,0 +1,237 @@
+#include "Presets.hpp"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_core.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/util.h>
+
+#include "Preset.hpp"
+#include "Synthesizer.hpp"
+
+LOG_MODULE_REGISTER(presets, LOG_LEVEL_INF);
+
+#define PRESETS_PARTITION_ID FIXED_PARTITION_ID(storage_partition)
+
+// Identifies the log on the storage partition.
+constexpr uint32_t FCB_MAGIC  = 0x53594e54;  // "SYNT"
+constexpr uint8_t FCB_VERSION = 1;
+
+// Entry of the log. Later entries of a slot supersede the earlier ones.
+struct Record {
+    uint8_t slot;
+    Preset preset;
+};
+
+struct fcb Presets::fcb;
+struct flash_sector Presets::sectors[];
+struct k_mutex Presets::lock;
+struct k_work_delayable Presets::autosave_work;
+Preset Presets::stored[];
+bool Presets::is_stored[];
+
+int Presets::write(const unsigned int slot, const Preset& preset) {
+    const Record record = {.slot = (uint8_t)slot, .preset = preset};
+    struct fcb_entry loc;
+    int ret;
+
+    ret = fcb_append(&fcb, sizeof(record), &loc);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), &record, sizeof(record));
+    if (ret < 0) {
+        LOG_ERR("Failed to write preset: %d", -ret);
+        return ret;
+    }
+
+    ret = fcb_append_finish(&fcb, &loc);
+    if (ret < 0) {
+        LOG_ERR("Failed to commit preset: %d", -ret);
+        return ret;
+    }
+
+    return 0;
+}
+
+int Presets::rotate(const unsigned int slot, const Preset& preset) {
+    int ret;
+
+    // Carry every slot over to the spare sector before the oldest one is
+    // erased, so that a power loss in between loses no preset.
+    ret = fcb_append_to_scratch(&fcb);
+    if (ret == -ENOSPC) {
+        // Logs written before a sector was kept spare fill all of them. Free
+        // the oldest one first, this once.
+        ret = fcb_rotate(&fcb);
+        if (ret == 0) {
+            ret = fcb_append_to_scratch(&fcb);
+        }
+    }
+    if (ret < 0) {
+        LOG_ERR("Failed to open the spare preset sector: %d", -ret);
+        return ret;
+    }
+
+    ret = write(slot, preset);
+    for (unsigned int i = 0; i < SLOT_COUNT && ret == 0; ++i) {
+        if (is_stored[i] && i != slot) {
+            ret = write(i, stored[i]);
+        }
+    }
+    if (ret < 0) {
+        LOG_ERR("Failed to carry the presets over: %d", -ret);
+        return ret;
+    }
+
+    // The erased sector becomes the next spare one.
+    // NOTE: Erasing a 128 KiB sector takes 1 to 2 s, during which every fetch
+    // from flash stalls, the interrupt handlers and the audio thread included.
+    // The audio output drops out meanwhile.
+    ret = fcb_rotate(&fcb);
+    if (ret < 0) {
+        LOG_ERR("Failed to rotate the preset log: %d", -ret);
+        return ret;
+    }
+
+    return 0;
+}
+
+int Presets::append(const unsigned int slot, const Preset& preset, const bool may_rotate) {
+    int ret;
+
+    ret = write(slot, preset);
+    if (ret == -ENOSPC) {
+        if (!may_rotate) {
+            return -EAGAIN;
+        }
+        ret = rotate(slot, preset);
+    } else if (ret < 0) {
+        LOG_ERR("Failed to append to the preset log: %d", -ret);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    stored[slot]    = preset;
+    is_stored[slot] = true;
+
+    return 0;
+}
+
+int Presets::init(void) {
+    int ret;
+
+    k_mutex_init(&lock);
+    k_work_init_delayable(&autosave_work, [](struct k_work* const item) {
+        // Hold a rotation of the log off until nothing plays, so that the
+        // flash erase does not cut the sound off.
+        if (store(AUTOSAVE_SLOT, !Synthesizer::is_playing()) == -EAGAIN) {
+            schedule_autosave();
+        }
+    });
+
+    uint32_t sector_count = ARRAY_SIZE(sectors);
+    ret                   = flash_area_get_sectors(PRESETS_PARTITION_ID, &sector_count,
+                                                   sectors);
+    if (ret < 0) {
+        LOG_ERR("Failed to get the storage sectors: %d", -ret);
+        return ret;
+    }
+
+    fcb.f_magic       = FCB_MAGIC;
+    fcb.f_version     = FCB_VERSION;
+    fcb.f_sector_cnt  = sector_count;
+    fcb.f_scratch_cnt = 1;
+    fcb.f_sectors     = sectors;
+    ret               = fcb_init(PRESETS_PARTITION_ID, &fcb);
+    if (ret < 0) {
+        LOG_ERR("Failed to mount the preset log: %d", -ret);
+        return ret;
+    }
+
+    (void)memset(is_stored, 0, sizeof(is_stored));
+    ret = fcb_walk(
+        &fcb, nullptr,
+        [](struct fcb_entry_ctx* const ctx, void* const arg) -> int {
+            Record record;
+
+            if (ctx->loc.fe_data_len != sizeof(record)) {
+                return 0;
+            }
+
+            const int ret = flash_area_read(ctx->fap, FCB_ENTRY_FA_DATA_OFF(ctx->loc),
+                                            &record, sizeof(record));
+            if (ret < 0 || record.slot >= SLOT_COUNT ||
+                record.preset.version != Preset::VERSION) {
+                return 0;
+            }
+
+            stored[record.slot]    = record.preset;
+            is_stored[record.slot] = true;
+            return 0;
+        },
+        nullptr);
+    if (ret < 0) {
+        LOG_ERR("Failed to read the preset log: %d", -ret);
+        return ret;
+    }
+
+    if (is_stored[AUTOSAVE_SLOT]) {
+        Synthesizer::recall(stored[AUTOSAVE_SLOT]);
+    }
+
+    return 0;
+}
+
+void Presets::schedule_autosave(void) {
+    // Every change pushes the write back, so a knob sweep costs a single entry.
+    (void)k_work_reschedule(&autosave_work, K_MSEC(CONFIG_SYNTH_PRESET_AUTOSAVE_DELAY_MS));
+}
+
+int Presets::store(const unsigned int slot, const bool may_rotate) {
+    int ret = 0;
+
+    if (slot >= SLOT_COUNT) {
+        return -EINVAL;
+    }
+
+    Preset preset;
+    Synthesizer::get_preset(&preset);
+
+    (void)k_mutex_lock(&lock, K_FOREVER);
+    if (!is_stored[slot] || memcmp(&stored[slot], &preset, sizeof(preset)) != 0) {
+        ret = append(slot, preset, may_rotate);
+    }
+    (void)k_mutex_unlock(&lock);
+
+    return ret;
+}
+
+int Presets::save(const unsigned int slot) {
+    return store(slot, !Synthesizer::is_playing());
+}
+
+int Presets::load(const unsigned int slot) {
+    if (slot >= SLOT_COUNT) {
+        return -EINVAL;
+    }
+
+    (void)k_mutex_lock(&lock, K_FOREVER);
+    const bool found    = is_stored[slot];
+    const Preset preset = stored[slot];
+    (void)k_mutex_unlock(&lock);
+
+    if (!found) {
+        return -ENOENT;
+    }
+
+    Synthesizer::recall(preset);
+
+    return 0;
+}
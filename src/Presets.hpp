@@ -0,0 +1,56 @@
+#pragma once
+
+#include <zephyr/fs/fcb.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "Preset.hpp"
+
+class Presets {
+   public:
+    static constexpr unsigned int SLOT_COUNT = 8;
+
+    // Holds the last state, restored at boot.
+    static constexpr unsigned int AUTOSAVE_SLOT = 0;
+
+   private:
+    static struct fcb fcb;
+    static struct flash_sector sectors[4];
+    static struct k_mutex lock;
+    static struct k_work_delayable autosave_work;
+    // Latest stored preset of every slot, to skip redundant writes.
+    static Preset stored[SLOT_COUNT];
+    static bool is_stored[SLOT_COUNT];
+
+    static int write(unsigned int slot, const Preset& preset);
+    static int rotate(unsigned int slot, const Preset& preset);
+    static int append(unsigned int slot, const Preset& preset, bool may_rotate);
+    static int store(unsigned int slot, bool may_rotate);
+
+   public:
+    // Disallow creating an instance of this class.
+    Presets() = delete;
+
+    /// @brief Preset storage initialization function
+    /// Mounts the log on the storage partition and recalls the autosaved state.
+    /// @return 0 on success, -ERRNO otherwise
+    static int init(void);
+
+    /// @brief Store the current state once it has not changed for a while
+    /// Changes within the delay are coalesced into a single write.
+    static void schedule_autosave(void);
+
+    /// @brief Store the current state in a slot
+    /// Nothing is written if the slot already holds the same preset. Once the log
+    /// is full, its oldest sector has to be erased, which stalls every fetch from
+    /// flash for 1 to 2 s. That is refused while a note plays.
+    /// @param slot preset slot, below SLOT_COUNT
+    /// @return 0 on success, -EAGAIN if the log is full and a note plays,
+    /// -ERRNO otherwise
+    static int save(unsigned int slot);
+
+    /// @brief Recall the preset of a slot
+    /// @param slot preset slot, below SLOT_COUNT
+    /// @return 0 on success, -ENOENT if the slot is empty, -ERRNO otherwise
+    static int load(unsigned int slot);
+};
@@ -1,7 +1,6 @@
 #include "RotaryEncoder.hpp"
 
 #include <errno.h>
-#include <sys/cdefs.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/kernel.h>
@@ -12,14 +11,28 @@
 
 #include <cstdint>
 
-LOG_MODULE_REGISTER(rotary_encoder, LOG_LEVEL_INF);
+#include "trace.h"
 
-RotaryEncoder::RotaryEncoder(const Pins pins, const Callback callback)
-    : callback(callback), prev_pin_state(0), pins(pins) {}
+LOG_MODULE_REGISTER(rotary_encoder, LOG_LEVEL_INF);
 
-uint8_t RotaryEncoder::read_pins(void) {
-    const bool a = gpio_pin_get_dt(&this->pins.a);
-    const bool b = gpio_pin_get_dt(&this->pins.b);
+// Step taken by each transition, indexed by (previous state << 2) | state,
+// where a state is (B << 1) | A. The gray code paths are
+// 00 -> 01 -> 11 -> 10 -> 00: Clockwise
+// 00 -> 10 -> 11 -> 01 -> 00: Anticlockwise
+// Staying put and skipping a state (both pins flipped) are worth no step, so
+// contact bounce on a single pin cancels itself out.
+static constexpr int8_t TRANSITION_STEPS[16] = {
+    0, +1, -1, 0,  // from 00
+    -1, 0, 0, +1,  // from 01
+    +1, 0, 0, -1,  // from 10
+    0, -1, +1, 0,  // from 11
+};
+
+RotaryEncoder::RotaryEncoder(const Pins pins) : prev_pin_state(0), steps(0), pins(pins) {}
+
+uint8_t RotaryEncoder::decode_pins(const gpio_port_value_t snapshot) {
+    const bool a = snapshot & BIT(this->pins.a.pin);
+    const bool b = snapshot & BIT(this->pins.b.pin);
 
     return (b << 1) | a;
 }
@@ -27,52 +40,28 @@ uint8_t RotaryEncoder::read_pins(void) {
 int RotaryEncoder::init(void) {
     int ret;
 
-    ret = gpio_pin_configure_dt(&this->pins.a, GPIO_INPUT);
-    if (ret < 0) {
-        LOG_ERR("Failed to initialize pin A: %d", -ret);
-        return ret;
+    if (!gpio_is_ready_dt(&this->pins.a) || !gpio_is_ready_dt(&this->pins.b)) {
+        LOG_ERR("GPIO port was not ready");
+        return -EBUSY;
     }
 
-    ret = gpio_pin_configure_dt(&this->pins.b, GPIO_INPUT);
-    if (ret < 0) {
-        LOG_ERR("Failed to initialize pin B: %d", -ret);
-        return ret;
+    if (this->pins.a.port != this->pins.b.port) {
+        LOG_ERR("Pins A and B must be on the same port");
+        return -EINVAL;
     }
 
-    k_work_init_delayable(&this->dwork, [](struct k_work* const item) {
-        struct k_work_delayable* dwork = k_work_delayable_from_work(item);
-        RotaryEncoder* sw              = CONTAINER_OF(dwork, RotaryEncoder, dwork);
-        sw->update();
-    });
-
-    gpio_init_callback(
-        &this->a_cb,
-        [](const struct device* dev, struct gpio_callback* cb, gpio_port_pins_t pins) {
-            RotaryEncoder* enc = CONTAINER_OF(cb, RotaryEncoder, a_cb);
-            k_work_schedule(&enc->dwork, K_MSEC(5));
-        },
-        BIT(pins.a.pin));
-    ret = gpio_add_callback(this->pins.a.port, &this->a_cb);
+    ret = gpio_pin_configure_dt(&this->pins.a, GPIO_INPUT);
     if (ret < 0) {
-        LOG_ERR("Could not add callback to pin A: %d", -ret);
+        LOG_ERR("Failed to initialize pin A: %d", -ret);
         return ret;
     }
 
-    gpio_init_callback(
-        &this->b_cb,
-        [](const struct device* dev, struct gpio_callback* cb, gpio_port_pins_t pins) {
-            RotaryEncoder* enc = CONTAINER_OF(cb, RotaryEncoder, b_cb);
-            k_work_schedule(&enc->dwork, K_MSEC(5));
-        },
-        BIT(pins.b.pin));
-    ret = gpio_add_callback(this->pins.b.port, &this->b_cb);
+    ret = gpio_pin_configure_dt(&this->pins.b, GPIO_INPUT);
     if (ret < 0) {
-        LOG_ERR("Could not add callbacks to pin B: %d", -ret);
+        LOG_ERR("Failed to initialize pin B: %d", -ret);
         return ret;
     }
 
-    this->prev_pin_state = this->read_pins();
-
     ret = gpio_pin_interrupt_configure_dt(&pins.a, GPIO_INT_EDGE_BOTH);
     if (ret < 0) {
         LOG_ERR("Could not enabled interrupts for pin A: %d", -ret);
@@ -88,50 +77,56 @@ int RotaryEncoder::init(void) {
     return 0;
 }
 
-int RotaryEncoder::update(void) {
-    const uint8_t pin_state = this->read_pins();
+const struct device* RotaryEncoder::get_port(void) {
+    return this->pins.a.port;
+}
 
-    // No change observed.
-    if (pin_state == this->prev_pin_state) {
-        return 0;
-    }
+gpio_port_pins_t RotaryEncoder::get_pin_mask(void) {
+    return BIT(this->pins.a.pin) | BIT(this->pins.b.pin);
+}
+
+void RotaryEncoder::reset(const gpio_port_value_t snapshot) {
+    this->prev_pin_state = this->decode_pins(snapshot);
+}
+
+int RotaryEncoder::update(const gpio_port_value_t snapshot) {
+    const uint8_t pin_state = this->decode_pins(snapshot);
+    SYNTH_TRACE("encoder_update", this->pins.a.pin, pin_state);
 
-    // The mask follows the following gray code paths:
-    // 00 -> 01 -> 11 -> 10 -> 00: Clockwise
-    // 00 -> 10 -> 11 -> 01 -> 00: Anticlockwise
+    const uint8_t prev_pin_state = this->prev_pin_state;
+    this->prev_pin_state         = pin_state;
 
-    // Input leads to a non-gray code transition, which is ambiguous.
-    if ((pin_state & this->prev_pin_state) == 0) {
+    // Both pins changed between two reads, the direction is ambiguous.
+    if ((prev_pin_state ^ pin_state) == 0b11) {
         LOG_DBG("Reached an ambiguous transition");
-        this->prev_pin_state = pin_state;
         return -EINVAL;
     }
 
-    // At this point, the state transition could either cause an increment or
-    // decrement.
-    bool is_clockwise;
-    switch (this->prev_pin_state) {
-        case 0b00:
-            is_clockwise = pin_state == 0b01;
-            break;
-        case 0b01:
-            is_clockwise = pin_state == 0b11;
-            break;
-        case 0b10:
-            is_clockwise = pin_state == 0b00;
-            break;
-        case 0b11:
-            is_clockwise = pin_state == 0b10;
-            break;
-        default:
-            __unreachable();
-    }
+    this->steps += TRANSITION_STEPS[(prev_pin_state << 2) | pin_state];
 
-    this->prev_pin_state = pin_state;
+    return 0;
+}
 
-    if (this->callback != nullptr) {
-        this->callback(is_clockwise);
+int32_t RotaryEncoder::accelerate(const int32_t steps) {
+    const int32_t magnitude = steps < 0 ? -steps : steps;
+    if (magnitude <= CONFIG_SYNTH_ENCODER_ACCEL_THRESHOLD) {
+        return steps;
     }
 
-    return 0;
+    // Grow quadratically with the steps beyond the threshold.
+    const int32_t excess = magnitude - CONFIG_SYNTH_ENCODER_ACCEL_THRESHOLD;
+    const int32_t extra  = excess * excess * CONFIG_SYNTH_ENCODER_ACCEL_PERCENT / 100;
+
+    return steps < 0 ? steps - extra : steps + extra;
+}
+
+bool RotaryEncoder::has_steps(void) {
+    return this->steps != 0;
+}
+
+int32_t RotaryEncoder::take_steps(void) {
+    const int32_t steps = this->steps;
+    this->steps         = 0;
+
+    return accelerate(steps);
 }
@@ -14,37 +14,54 @@
 
 class RotaryEncoder {
    public:
-    struct k_work_delayable dwork;
-    typedef void (*Callback)(bool is_clockwise);
     typedef struct {
         const struct gpio_dt_spec a;
         const struct gpio_dt_spec b;
     } Pins;
 
    private:
-    struct gpio_callback a_cb;
-    struct gpio_callback b_cb;
-    Callback callback;
     uint8_t prev_pin_state;
+    int32_t steps;
     Pins pins;
 
-    uint8_t read_pins(void);
+    uint8_t decode_pins(gpio_port_value_t snapshot);
+    static int32_t accelerate(int32_t steps);
 
    public:
     /// @brief Encoder constructor
+    /// Both pins must be on the same GPIO port.
     /// @param pins Encoder pins
-    /// @param min_value The minimum value that the encoder state can reach
-    /// @param max_value The maximum value that the encoder state can reach
-    /// @param callback Callback to be executed on state change.
-    RotaryEncoder(Pins pins, Callback callback = nullptr);
+    RotaryEncoder(Pins pins);
 
     /// @brief Encoder initialization function
-    /// Call this function during initialization
-    /// @return Returns 0 on success, -EINVAL if invalid bounds (lower >= upper)
+    /// Configures the pins and their interrupts. The pins are read by the input
+    /// scanner, which then calls update().
+    /// @return 0 on success, -ERRNO otherwise
     int init(void);
 
-    /// @brief Update the encoder
-    /// @param pin0
-    /// @param pin1
-    int update(void);
+    /// @brief Get the GPIO port the encoder is on
+    /// @return port device
+    const struct device* get_port(void);
+
+    /// @brief Get the encoder pins within its port
+    /// @return pin mask
+    gpio_port_pins_t get_pin_mask(void);
+
+    /// @brief Take the pin state as reference without decoding a transition
+    /// @param snapshot logical value of the whole port
+    void reset(gpio_port_value_t snapshot);
+
+    /// @brief Decode the transition to a new pin state and accumulate its step
+    /// @param snapshot logical value of the whole port
+    /// @return 0 on success, -EINVAL on an ambiguous transition
+    int update(gpio_port_value_t snapshot);
+
+    /// @brief Check whether steps are waiting to be taken
+    /// @return true if take_steps() would return a non-zero delta
+    bool has_steps(void);
+
+    /// @brief Take the steps accumulated since the last call
+    /// @return signed delta, positive when clockwise, scaled by the
+    /// acceleration curve
+    int32_t take_steps(void);
 };
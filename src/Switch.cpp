@@ -10,6 +10,8 @@
 #include <zephyr/sys/util.h>
 #include <zephyr/sys/util_macro.h>
 
+#include "trace.h"
+
 LOG_MODULE_REGISTER(switch, LOG_LEVEL_INF);
 
 Switch::State Switch::read_state(void) {
@@ -28,9 +30,14 @@ Switch::State Switch::read_state(void) {
     return state;
 }
 
-int Switch::init(void) {
+int Switch::init(const gpio_callback_handler_t handler) {
     int ret;
 
+    if (this->pins.up.port != this->pins.down.port) {
+        LOG_ERR("Pins up and down must be on the same port");
+        return -EINVAL;
+    }
+
     if (!gpio_is_ready_dt(&this->pins.up)) {
         LOG_ERR("GPIO up was not ready");
         return -EBUSY;
@@ -51,39 +58,15 @@ int Switch::init(void) {
         return ret;
     }
 
-    k_work_init_delayable(&this->dwork, [](struct k_work* const item) {
-        struct k_work_delayable* dwork = k_work_delayable_from_work(item);
-        Switch* sw                     = CONTAINER_OF(dwork, Switch, dwork);
-        sw->update();
-    });
-
-    gpio_init_callback(
-        &this->up_cb,
-        [](const struct device* dev, struct gpio_callback* cb, gpio_port_pins_t pins) {
-            Switch* sw = CONTAINER_OF(cb, Switch, up_cb);
-            k_work_schedule(&sw->dwork, K_MSEC(10));
-        },
-        BIT(pins.up.pin));
-    ret = gpio_add_callback(this->pins.up.port, &this->up_cb);
-    if (ret < 0) {
-        LOG_ERR("Could not add callback to up pin: %d", -ret);
-        return ret;
-    }
-
-    gpio_init_callback(
-        &this->down_cb,
-        [](const struct device* dev, struct gpio_callback* cb, gpio_port_pins_t pins) {
-            Switch* sw = CONTAINER_OF(cb, Switch, down_cb);
-            k_work_schedule(&sw->dwork, K_MSEC(10));
-        },
-        BIT(pins.down.pin));
-    ret = gpio_add_callback(this->pins.down.port, &this->down_cb);
+    gpio_init_callback(&this->cb, handler, BIT(pins.up.pin) | BIT(pins.down.pin));
+    ret = gpio_add_callback(this->pins.up.port, &this->cb);
     if (ret < 0) {
-        LOG_ERR("Could not add callbacks to down pin: %d", -ret);
+        LOG_ERR("Could not add callback to the pins: %d", -ret);
         return ret;
     }
 
-    this->last_state = this->read_state();
+    this->last_state    = this->read_state();
+    this->sampled_state = this->last_state;
 
     ret = gpio_pin_interrupt_configure_dt(&pins.up, GPIO_INT_EDGE_BOTH);
     if (ret < 0) {
@@ -100,14 +83,27 @@ int Switch::init(void) {
     return 0;
 }
 
-void Switch::update(void) {
-    State state = this->read_state();
-    if (state != this->last_state && this->callback != nullptr) {
-        this->callback(state);
+bool Switch::debounce(void) {
+    const State state = this->read_state();
+    SYNTH_TRACE("switch_update", this->pins.up.pin, state);
+
+    // A bouncing contact rarely reads the same across two scans.
+    const bool is_stable = state == this->sampled_state;
+    this->sampled_state  = state;
+    if (!is_stable || state == this->last_state) {
+        return false;
     }
 
     this->last_state = state;
+    return true;
+}
+
+bool Switch::is_settled(void) {
+    return this->sampled_state == this->last_state;
+}
+
+Switch::State Switch::get_state(void) {
+    return this->last_state;
 }
 
-Switch::Switch(Pins pins, Callback callback)
-    : pins(pins), last_state(NEUTRAL), callback(callback) {}
+Switch::Switch(Pins pins) : pins(pins), last_state(NEUTRAL), sampled_state(NEUTRAL) {}
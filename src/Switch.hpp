@@ -12,36 +12,42 @@
 
 class Switch {
    public:
-    struct k_work_delayable dwork;
     enum State { DOWN, NEUTRAL, UP };
     struct Pins {
         const struct gpio_dt_spec up;
         const struct gpio_dt_spec down;
     };
-    // Switch's callback type definition, called when the switch changes its state
-    typedef void (*Callback)(State state);
 
    private:
-    struct gpio_callback up_cb;
-    struct gpio_callback down_cb;
+    struct gpio_callback cb;
     Pins pins;
     State last_state;
-    Callback callback;
+    State sampled_state;
 
     Switch::State read_state(void);
 
    public:
     /// @brief Constructor
-    /// Call this function during initialization before calling the rest of the fuctions
+    /// Both pins must be on the same GPIO port.
     /// @param pins Up and down pins
-    /// @param callback the callback that is called when the switch changes its state.
-    /// no callback
-    Switch(Pins pins, Callback callback = nullptr);
+    Switch(Pins pins);
 
     /// @brief Switch's initialization function
+    /// Configures the pins and calls @p handler on their edges. The pins are
+    /// then sampled by the input scanner, which calls debounce().
+    /// @param handler GPIO callback handler for the edges of both pins
     /// @return 0 on success, -ERRNO otherwise
-    int init(void);
+    int init(gpio_callback_handler_t handler);
 
-    /// @brief Switch update function.
-    void update(void);
+    /// @brief Sample the pins and accept a state once two samples in a row agree
+    /// @return true if the debounced state changed
+    bool debounce(void);
+
+    /// @brief Check whether the last sample matches the debounced state
+    /// @return true if no state change is in progress
+    bool is_settled(void);
+
+    /// @brief Get the debounced state
+    /// @return the switch state
+    State get_state(void);
 };
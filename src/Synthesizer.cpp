@@ -1,217 +1,712 @@
 #include "Synthesizer.hpp"
 
 #include <errno.h>
+#include <math.h>
 #include <stdint.h>
 #include <sys/cdefs.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/logging/log_core.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/sys_clock.h>
+#include <zephyr/toolchain.h>
+
+#ifdef __ARM_FEATURE_DSP
+#include <cmsis_core.h>
+#endif  // __ARM_FEATURE_DSP
 
 #include <cstdint>
 
 #include "Audio.hpp"
 #include "KeyPress.hpp"
+#include "Preset.hpp"
+#include "Presets.hpp"
+#include "Synthesizer/Key.hpp"
+#include "Synthesizer/Noise.hpp"
 #include "Synthesizer/Oscillator.hpp"
+#include "Synthesizer/Percussion.hpp"
+#include "Synthesizer/Sampler.hpp"
+#include "Synthesizer/Wavetable.hpp"
+#include "Synthesizer/sample_bank.h"
+#include "Telemetry.hpp"
 #include "USB.hpp"
+#include "placement.h"
+#include "trace.h"
 
 LOG_MODULE_REGISTER(synthesizer, LOG_LEVEL_INF);
 
 Oscillator Synthesizer::osc[];
 Synthesizer::Mode Synthesizer::current_mode;
 Synthesizer::Effect Synthesizer::current_effect;
+Synthesizer::VoiceMode Synthesizer::voice_mode;
+uint8_t Synthesizer::mod_index;
+uint8_t Synthesizer::unison;
+uint8_t Synthesizer::detune;
+uint8_t Synthesizer::sample;
 uint8_t Synthesizer::master_volume;
+uint32_t Synthesizer::pitch_bend;
+Preset Synthesizer::pending_preset;
+bool Synthesizer::has_pending_preset;
+struct k_spinlock Synthesizer::preset_lock;
+struct k_mutex Synthesizer::render_lock;
+atomic_t Synthesizer::overruns;
+
+static_assert(Audio::CHANNEL_COUNT == 2, "Voices render left and right frames");
+
+// Rendering state of the playing keys, rebuilt every block.
+static Synthesizer::Voice voices[MAX_KEYPRESSES] SYNTH_VOICE_STATE;
+
+constexpr unsigned int FRAME_COUNT = Audio::SAMPLES_PER_BLOCK / Audio::CHANNEL_COUNT;
+
+// White noise shared by every voice and hit, and the mono percussion mix.
+static int16_t __aligned(4) noise_block[ROUND_UP(FRAME_COUNT, 2)] SYNTH_VOICE_STATE;
+static int16_t percussion_block[FRAME_COUNT] SYNTH_VOICE_STATE;
+
+// Frames rendered between two checks of the render deadline.
+constexpr unsigned int DEADLINE_CHECK_FRAMES = 64;
+
+// Given by every note_on(), wakes the audio thread up from power-down.
+K_SEM_DEFINE(note_sem, 0, 1);
+
+// Semitones covered by a full pitch bend.
+constexpr float PITCH_BEND_RANGE = 2;
+
+#ifdef CONFIG_SYNTH_GAIN_RAMP
+// Mixer gain as a Q15 factor, making up for the codec volume lagging behind.
+static int32_t gain = 0x8000;
+
+// Codec steps the mixer gain makes up for at most, 6 dB either way.
+constexpr int GAIN_MAX_STEPS = 12;
+#endif  // CONFIG_SYNTH_GAIN_RAMP
+
+// Pack two samples into a word, the first one in the low halfword.
+static ALWAYS_INLINE uint32_t pack(const int16_t low, const int16_t high) {
+    return (uint16_t)low | (uint32_t)(uint16_t)high << 16;
+}
 
-static const char *const MODE_STRING_MAP[Synthesizer::Mode::COUNT] = {
-    [Synthesizer::Mode::OSC1]   = "OSC1",
-    [Synthesizer::Mode::OSC2]   = "OSC2",
-    [Synthesizer::Mode::MASTER] = "MASTER",
-};
+// Multiply both halfwords pairwise and add the products to the accumulator.
+static ALWAYS_INLINE int32_t smlad(const uint32_t x, const uint32_t y, const int32_t acc) {
+#ifdef __ARM_FEATURE_DSP
+    return __SMLAD(x, y, acc);
+#else
+    return acc + (int16_t)x * (int16_t)y + (int16_t)(x >> 16) * (int16_t)(y >> 16);
+#endif  // __ARM_FEATURE_DSP
+}
 
-static const char *const WAVETYPE_STRING_MAP[Oscillator::WaveType::COUNT] = {
-    [Oscillator::WaveType::SINE]     = "Sine",
-    [Oscillator::WaveType::TRIANGLE] = "Triangle",
-    [Oscillator::WaveType::SQUARE]   = "Square",
-    [Oscillator::WaveType::SAWTOOTH] = "Sawtooth",
-};
+// Persist parameter changes once they settle.
+static inline void state_changed(void) {
+#ifdef CONFIG_SYNTH_PRESETS
+    Presets::schedule_autosave();
+#endif  // CONFIG_SYNTH_PRESETS
+}
 
 void Synthesizer::init(void) {
     master_volume = UINT8_MAX;
+    pitch_bend    = 0x10000;
+    unison        = 1;
+
+    k_mutex_init(&render_lock);
+    Wavetable::init();
+}
+
+int Synthesizer::note_on(const Key key, const uint8_t velocity, const k_timeout_t hold_time) {
+    bool key_pressed = false;
+    for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
+        if (keypresses[i].k == key && keypresses[i].state != KeyPress::IDLE) {
+            keypresses[i].state           = KeyPress::PRESSED;
+            keypresses[i].hold_time       = sys_timepoint_calc(hold_time);
+            keypresses[i].release_time    = sys_timepoint_calc(hold_time);
+            keypresses[i].velocity        = velocity;
+            keypresses[i].sample_position = 0;
+            key_pressed                   = true;
+            SYNTH_TRACE("note_retrigger", velocity, i);
+        }
+    }
+    if (key_pressed) {
+        k_sem_give(&note_sem);
+        return 0;
+    }
+
+    // The second loop is necessary to avoid selecting an IDLE key when a
+    // PRESSED or RELEASED key is located further away on the array
+    for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
+        if (keypresses[i].state == KeyPress::IDLE) {
+            keypresses[i].k               = key;
+            keypresses[i].state           = KeyPress::PRESSED;
+            keypresses[i].hold_time       = sys_timepoint_calc(hold_time);
+            keypresses[i].release_time    = sys_timepoint_calc(hold_time);
+            keypresses[i].phase[0]        = 0;
+            keypresses[i].phase[1]        = 0;
+            keypresses[i].velocity        = velocity;
+            keypresses[i].sample_position = 0;
+            // Golden ratio spacing keeps the unison copies from starting in phase.
+            for (unsigned int j = 0; j < MAX_UNISON; ++j) {
+                keypresses[i].unison_phase[j] = j * 0x9e3779b9;
+            }
+            SYNTH_TRACE("note_on", velocity, i);
+            k_sem_give(&note_sem);
+            return 0;
+        }
+    }
+
+    return -ENOMEM;
+}
+
+void Synthesizer::note_off(const Key key) {
+    for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
+        if (keypresses[i].k == key && keypresses[i].state != KeyPress::IDLE) {
+            keypresses[i].state = KeyPress::IDLE;
+            SYNTH_TRACE("note_off", 0, i);
+        }
+    }
+}
+
+void Synthesizer::all_notes_off(void) {
+    for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
+        keypresses[i].state = KeyPress::IDLE;
+    }
+    Percussion::stop();
+}
+
+int Synthesizer::hit(const Percussion::Sound sound, const uint8_t velocity) {
+    const int ret = Percussion::trigger(sound, velocity);
+    if (ret < 0) {
+        return ret;
+    }
+
+    SYNTH_TRACE("hit", velocity, sound);
+    k_sem_give(&note_sem);
+    return 0;
+}
+
+void Synthesizer::set_pitch_bend(const int16_t bend) {
+    pitch_bend = exp2f(bend * PITCH_BEND_RANGE / (8192 * 12)) * 0x10000;
+}
+
+void Synthesizer::set_unison(const uint8_t voices, const uint8_t detune) {
+    Synthesizer::unison = CLAMP(voices, 1, MAX_UNISON);
+    Synthesizer::detune = MIN(detune, MAX_DETUNE);
+
+    Telemetry::post(Telemetry::UNISON, Mode::MASTER,
+                    Synthesizer::unison << 8 | Synthesizer::detune);
+    state_changed();
+}
+
+int Synthesizer::set_sample(const uint8_t index) {
+    if (index >= Sampler::count()) {
+        return -EINVAL;
+    }
+
+    sample = index;
+
+    Telemetry::post(Telemetry::SAMPLE, Mode::MASTER, sample);
+    state_changed();
+    return 0;
+}
+
+void Synthesizer::set_master_volume(const uint8_t volume) {
+    master_volume = volume;
+
+    // Never wait on the codec, a burst of changes ends up in a single write.
+    Audio::set_volume_async(master_volume);
+
+    Telemetry::post(Telemetry::VOLUME, Mode::MASTER, master_volume);
+    state_changed();
 }
 
-void Synthesizer::change_waveform(const bool must_increase) {
+void Synthesizer::change_waveform(const int delta) {
     Oscillator::WaveType waveform;
     switch (current_mode) {
         case Mode::OSC1:
         case Mode::OSC2:
-            waveform = osc[current_mode].change_waveform(must_increase);
-            USB::println("[%s] Waveform: %s", MODE_STRING_MAP[current_mode],
-                         WAVETYPE_STRING_MAP[waveform]);
+            waveform = osc[current_mode].change_waveform(delta);
+            Telemetry::post(Telemetry::WAVEFORM, current_mode, waveform);
+            state_changed();
             break;
-        case Mode::MASTER:
-            USB::println("[MASTER] LPF resonance (pending feature)");
-            return;
+        case Mode::MASTER: {
+            const int mode = (voice_mode + delta) % VOICE_MODE_COUNT;
+            voice_mode = static_cast<VoiceMode>(mode < 0 ? mode + VOICE_MODE_COUNT : mode);
+            Telemetry::post(Telemetry::VOICE_MODE, current_mode, voice_mode);
+            state_changed();
+            break;
+        }
         default:
             __unreachable();
     }
 }
 
-void Synthesizer::change_pitch(const bool must_increase) {
+void Synthesizer::use_wavetable(const Mode oscillator, const uint8_t slot) {
+    if (oscillator != Mode::OSC1 && oscillator != Mode::OSC2) {
+        return;
+    }
+
+    osc[oscillator].set_table(slot);
+    Telemetry::post(Telemetry::WAVEFORM, oscillator, Oscillator::WaveType::USER);
+    state_changed();
+}
+
+void Synthesizer::change_pitch(const int delta) {
     switch (current_mode) {
         case Mode::OSC1:
         case Mode::OSC2:
-            osc[current_mode].change_pitch(must_increase);
-            USB::println("[%s] Pitch: %f Hz", MODE_STRING_MAP[current_mode],
-                         osc[current_mode].get_freq_shift());
+            osc[current_mode].change_pitch(delta);
+            Telemetry::post(Telemetry::PITCH, current_mode,
+                            osc[current_mode].get_freq_shift() * 1000);
+            state_changed();
             break;
         case Mode::MASTER:
-            USB::println("[MASTER] LPF cutoff frequency (pending feature)");
+            mod_index = CLAMP(mod_index + delta, 0, MAX_MOD_INDEX);
+            Telemetry::post(Telemetry::MOD_INDEX, current_mode, mod_index);
+            state_changed();
             break;
         default:
             __unreachable();
     }
 }
 
-void Synthesizer::change_volume(const bool must_increase) {
+void Synthesizer::change_volume(const int delta) {
     uint16_t volume;
-    int ret;
     switch (current_mode) {
         case Mode::OSC1:
         case Mode::OSC2:
-            volume = osc[current_mode].change_volume(must_increase);
+            volume = osc[current_mode].change_volume(delta);
             break;
         case Mode::MASTER:
-            master_volume = CLAMP(master_volume + (must_increase ? 1 : -1) * 2, 0, UINT8_MAX);
-            volume        = master_volume;
-            ret           = Audio::set_volume(master_volume);
-            if (ret < 0) {
-                LOG_ERR("Failed to set master volume: %d", -ret);
-            }
-            break;
+            set_master_volume(CLAMP(master_volume + delta * 2, 0, UINT8_MAX));
+            return;
         default:
             __unreachable();
     }
 
-    USB::println("[%s] Volume: %u", MODE_STRING_MAP[current_mode], volume);
+    Telemetry::post(Telemetry::VOLUME, current_mode, volume);
+    state_changed();
 }
 
 void Synthesizer::set_effect(const Effect effect) {
     current_effect = effect;
 
-    switch (effect) {
-        case LFO_MOD:
-            USB::println("Configuring LFO modulator (not implemented)");
-            break;
-        case AMP_MOD:
-            USB::println("Configuring amplitude modulator (not implemented)");
-            break;
-        case SPECIAL:
-            USB::println("Configuring special effects (not implemented)");
-            break;
-    }
+    Telemetry::post(Telemetry::EFFECT, current_mode, effect);
+    state_changed();
 }
 
 void Synthesizer::set_mode(const Mode mode) {
-    // Save the previous state
-    switch (mode) {
-        case MASTER:
-            // synth._master_volume_enc   = encoders[ENCODER_OSC_VOLUME].state;
-            break;
-        case OSC1:
-            // synth._osc1.volume_enc     = encoders[ENCODER_OSC_VOLUME].state;
-            // synth._osc1.wave_enc       = encoders[ENCODER_LPF_CUTOFF_OR_OSC_WAVE].state;
-            // synth._osc1.freq_shift_enc = encoders[ENCODER_LPF_RES_OR_OSC_FREQ].state;
-            break;
-        case OSC2:
-            // synth._osc2.volume_enc     = encoders[ENCODER_OSC_VOLUME].state;
-            // synth._osc2.wave_enc       = encoders[ENCODER_LPF_CUTOFF_OR_OSC_WAVE].state;
-            // synth._osc2.freq_shift_enc = encoders[ENCODER_LPF_RES_OR_OSC_FREQ].state;
-            break;
-        default:
-            __unreachable();
+    // Every mode keeps its own parameters and the encoders only report
+    // relative steps, so switching is just a matter of selecting them.
+    current_mode = mode;
+
+    Telemetry::post(Telemetry::MODE, mode, 0);
+}
+
+bool Synthesizer::is_idle(void) {
+    bool is_idle = true;
+    for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
+        if (keypresses[i].state != KeyPress::PRESSED) {
+            continue;
+        }
+
+        if (sys_timepoint_expired(keypresses[i].hold_time)) {
+            keypresses[i].state = KeyPress::IDLE;
+        } else {
+            is_idle = false;
+        }
+    }
+
+    return is_idle && Percussion::is_idle();
+}
+
+bool Synthesizer::is_playing(void) {
+    for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
+        if (keypresses[i].state == KeyPress::PRESSED &&
+            !sys_timepoint_expired(keypresses[i].hold_time)) {
+            return true;
+        }
+    }
+
+    return !Percussion::is_idle();
+}
+
+void Synthesizer::wait_for_note(void) {
+    // Reset before checking the voices, so that a note played in between
+    // still wakes the caller up.
+    k_sem_reset(&note_sem);
+    if (is_idle()) {
+        (void)k_sem_take(&note_sem, K_FOREVER);
+    }
+}
+
+void Synthesizer::get_preset(Preset *const preset) {
+    const k_spinlock_key_t key = k_spin_lock(&preset_lock);
+    if (has_pending_preset) {
+        // Recalled but not applied yet, e.g. while the audio output is powered down.
+        *preset               = pending_preset;
+        preset->master_volume = master_volume;
+        preset->effect        = current_effect;
+        k_spin_unlock(&preset_lock, key);
+        return;
+    }
+    k_spin_unlock(&preset_lock, key);
+
+    *preset = current_preset();
+}
+
+Preset Synthesizer::current_preset(void) {
+    return Preset{
+        .version          = Preset::VERSION,
+        .osc              = {osc[OSC1].get_settings(), osc[OSC2].get_settings()},
+        .master_volume    = master_volume,
+        .filter_cutoff    = 0,
+        .filter_resonance = 0,
+        .effect           = (uint8_t)current_effect,
+        .voice_mode       = (uint8_t)voice_mode,
+        .mod_index        = mod_index,
+        .unison           = unison,
+        .detune           = detune,
+        .sample           = sample,
+    };
+}
+
+Preset Synthesizer::clamp_preset(const Preset &preset) {
+    Preset clamped = preset;
+    for (unsigned int mode = OSC1; mode <= OSC2; ++mode) {
+        clamped.osc[mode].wave   = MIN(preset.osc[mode].wave, Oscillator::WaveType::COUNT - 1);
+        clamped.osc[mode].volume = MIN(preset.osc[mode].volume, Oscillator::MAX_VOLUME);
+    }
+    clamped.effect     = MIN(preset.effect, Effect::SPECIAL);
+    clamped.voice_mode = MIN(preset.voice_mode, VoiceMode::VOICE_MODE_COUNT - 1);
+    clamped.mod_index  = MIN(preset.mod_index, MAX_MOD_INDEX);
+    clamped.unison     = CLAMP(preset.unison, 1, MAX_UNISON);
+    clamped.detune     = MIN(preset.detune, MAX_DETUNE);
+
+    return clamped;
+}
+
+void Synthesizer::recall(const Preset &preset) {
+    if (preset.version != Preset::VERSION) {
+        LOG_WRN("Ignoring preset version %u", preset.version);
+        return;
+    }
+
+    // Stored presets and shell input may hold anything, clamp before the
+    // values are rendered or reported.
+    const Preset clamped = clamp_preset(preset);
+
+    const k_spinlock_key_t key = k_spin_lock(&preset_lock);
+    pending_preset             = clamped;
+    has_pending_preset         = true;
+    k_spin_unlock(&preset_lock, key);
+
+    // The codec volume is independent of the rendered blocks.
+    set_master_volume(clamped.master_volume);
+    set_effect(static_cast<Effect>(clamped.effect));
+
+    for (unsigned int mode = OSC1; mode <= OSC2; ++mode) {
+        Telemetry::post(Telemetry::WAVEFORM, static_cast<Mode>(mode), clamped.osc[mode].wave);
+        Telemetry::post(Telemetry::VOLUME, static_cast<Mode>(mode), clamped.osc[mode].volume);
+    }
+    Telemetry::post(Telemetry::VOICE_MODE, MASTER, clamped.voice_mode);
+    Telemetry::post(Telemetry::MOD_INDEX, MASTER, clamped.mod_index);
+    Telemetry::post(Telemetry::UNISON, MASTER, clamped.unison << 8 | clamped.detune);
+    if (clamped.sample < Sampler::count()) {
+        Telemetry::post(Telemetry::SAMPLE, MASTER, clamped.sample);
+    }
+}
+
+void Synthesizer::apply_preset(const Preset &preset) {
+    osc[OSC1].set_settings(preset.osc[OSC1]);
+    osc[OSC2].set_settings(preset.osc[OSC2]);
+    voice_mode = static_cast<VoiceMode>(preset.voice_mode);
+    mod_index  = preset.mod_index;
+    unison     = preset.unison;
+    detune     = preset.detune;
+    if (preset.sample < Sampler::count()) {
+        sample = preset.sample;
+    }
+}
+
+void Synthesizer::apply_pending_preset(void) {
+    const k_spinlock_key_t key = k_spin_lock(&preset_lock);
+    if (has_pending_preset) {
+        apply_preset(pending_preset);
+        has_pending_preset = false;
+    }
+    k_spin_unlock(&preset_lock, key);
+}
+
+void Synthesizer::prepare_voice(KeyPress &key, const VoiceMode mode,
+                                const uint8_t unison_count, const uint8_t detune_cents,
+                                Voice *const voice) {
+    voice->key       = &key;
+    voice->mode      = mode;
+    voice->mod_index = mod_index;
+
+    for (unsigned int mode = OSC1; mode <= OSC2; ++mode) {
+        // Shift the key's phase increment by the oscillator pitch and the pitch
+        // bend. Overflowing increments alias exactly like the frequency would.
+        const uint64_t increment =
+            (uint64_t)key.k.phase_increment() * osc[mode].get_phase_shift();
+        voice->increment[mode] = (increment >> 16) * pitch_bend >> 16;
+        voice->gain[mode] = osc[mode].get_gain() * (key.velocity + 1) >> 7;
+    }
+
+    if (voice->mode == VoiceMode::SAMPLE) {
+        voice->bank = Sampler::get(sample);
+        if (voice->bank != key.bank) {
+            // Another bank was selected while the key plays, whose position may
+            // lie past the end of the new one: start it over.
+            key.bank            = voice->bank;
+            key.sample_position = 0;
+        }
+        if (voice->bank != nullptr) {
+            voice->sample_step = Sampler::step(*voice->bank, voice->increment[OSC1]);
+        }
+        voice->unison = 1;
+        return;
+    }
+
+    voice->unison = unison_count;
+    if (voice->unison == 1) {
+        return;
+    }
+
+    // Spread the copies evenly from -detune_cents to +detune_cents and pan them
+    // from left to right, keeping the OSC1 gain on each channel.
+    const int32_t span               = voice->unison - 1;
+    const int32_t scale              = voice->unison * span;
+    int16_t copy_gain[2][MAX_UNISON] = {};
+    for (unsigned int i = 0; i < MAX_UNISON; ++i) {
+        if (i >= voice->unison) {
+            voice->unison_increment[i] = 0;
+            continue;
+        }
+
+        const int32_t position     = i;
+        const float cents          = (float)detune_cents * (2 * position - span) / span;
+        const uint32_t shift       = powf(2, cents / 1200) * 0x10000;
+        voice->unison_increment[i] = (uint64_t)voice->increment[OSC1] * shift >> 16;
+
+        copy_gain[0][i] = MIN(voice->gain[OSC1] * 2 * (span - position) / scale, INT16_MAX);
+        copy_gain[1][i] = MIN(voice->gain[OSC1] * 2 * position / scale, INT16_MAX);
+    }
+
+    for (unsigned int channel = 0; channel < 2; ++channel) {
+        for (unsigned int i = 0; i < MAX_UNISON / 2; ++i) {
+            voice->unison_gain[channel][i] =
+                pack(copy_gain[channel][2 * i], copy_gain[channel][2 * i + 1]);
+        }
+    }
+}
+
+// Play the sample bank of a voice, centered.
+static SYNTH_HOT_CODE void render_sample(Synthesizer::Voice &voice, int32_t frame[2]) {
+    const struct sample_bank *const bank = voice.bank;
+    KeyPress &key                        = *voice.key;
+
+    // One-shot samples stay silent once over, until the key is played again.
+    if (bank == nullptr || (key.sample_position >> 32) >= bank->length) {
+        return;
+    }
+
+    const int32_t sample = Sampler::interpolate(*bank, key.sample_position) *
+                           voice.gain[Synthesizer::OSC1] >> 15;
+    frame[0] += sample;
+    frame[1] += sample;
+
+    key.sample_position = Sampler::advance(*bank, key.sample_position, voice.sample_step);
+}
+
+SYNTH_HOT_CODE void Synthesizer::render_voice(Voice &voice, const int16_t noise,
+                                              int32_t frame[2]) {
+    KeyPress &key = *voice.key;
+
+    if (voice.mode == VoiceMode::SAMPLE) {
+        render_sample(voice, frame);
+        return;
+    }
+
+    key.phase[OSC2] += voice.increment[OSC2];
+    const int32_t modulator = osc[OSC2].waveform(key.phase[OSC2] >> 16, noise);
+
+    // Integer phase modulation: the modulator offsets the 16-bit carrier phase.
+    uint16_t offset = 0;
+    if (voice.mode == VoiceMode::FM) {
+        offset = modulator * voice.mod_index / MOD_INDEX_PER_PERIOD;
+    }
+
+    // Carrier on each channel, scaled by the Q15 OSC1 gain.
+    int32_t left;
+    int32_t right;
+    if (voice.unison == 1) {
+        key.phase[OSC1] += voice.increment[OSC1];
+        left  = osc[OSC1].waveform((key.phase[OSC1] >> 16) + offset, noise) *
+                voice.gain[OSC1];
+        right = left;
+    } else {
+        // Two copies per pass, sharing one dual multiply-accumulate per channel.
+        // An odd last copy is padded with a silent one.
+        left  = 0;
+        right = 0;
+        for (unsigned int i = 0; i < voice.unison; i += 2) {
+            key.unison_phase[i] += voice.unison_increment[i];
+            key.unison_phase[i + 1] += voice.unison_increment[i + 1];
+
+            const uint32_t samples =
+                pack(osc[OSC1].waveform((key.unison_phase[i] >> 16) + offset, noise),
+                     osc[OSC1].waveform((key.unison_phase[i + 1] >> 16) + offset, noise));
+            left  = smlad(samples, voice.unison_gain[0][i / 2], left);
+            right = smlad(samples, voice.unison_gain[1][i / 2], right);
+        }
     }
 
-    // Load the new state
-    switch (mode) {
-        case MASTER:
-            // encoders[ENCODER_OSC_VOLUME].state = synth._master_volume_enc;
-            // encoders[LPF_CUTOFF_ENC].state     = synth._lpf._cutoff_freq;
-            // encoders[LPF_RES_ENC].state        = synth._lpf._resonance_freq;
+    switch (voice.mode) {
+        case VoiceMode::FM:
+            frame[0] += left >> 15;
+            frame[1] += right >> 15;
             break;
-        case OSC1:
-            // encoders[ENCODER_OSC_VOLUME].state             = synth._osc1.volume_enc;
-            // encoders[ENCODER_LPF_CUTOFF_OR_OSC_WAVE].state = synth._osc1.wave_enc;
-            // encoders[OSC_FREQ_ENC].state                   = synth._osc1.freq_shift_enc;
+
+        case VoiceMode::RING:
+            frame[0] += ((left >> 15) * modulator) >> 15;
+            frame[1] += ((right >> 15) * modulator) >> 15;
             break;
-        case OSC2:
-            // encoders[ENCODER_OSC_VOLUME].state             = synth._osc2.volume_enc;
-            // encoders[ENCODER_LPF_CUTOFF_OR_OSC_WAVE].state = synth._osc2.wave_enc;
-            // encoders[OSC_FREQ_ENC].state                   = synth._osc2.freq_shift_enc;
+
+        default: {
+            // Both gains are at most 0x8000, so the sum cannot overflow.
+            const int32_t center = modulator * voice.gain[OSC2];
+            frame[0] += (left + center) >> 15;
+            frame[1] += (right + center) >> 15;
             break;
-        default:
-            __unreachable();
+        }
     }
+}
 
-    USB::println("[%s] Configured", MODE_STRING_MAP[mode]);
+void Synthesizer::apply_pending(void) {
+    if (k_mutex_lock(&render_lock, K_NO_WAIT) < 0) {
+        return;
+    }
 
-    current_mode = mode;
+    apply_pending_preset();
+    Wavetable::swap();
 
-    // // Call the encoder's callbacks
-    // encoders[ENCODER_OSC_VOLUME].callback(encoders[ENCODER_OSC_VOLUME]);
-    // encoders[ENCODER_LPF_CUTOFF_OR_OSC_WAVE].callback(
-    //     encoders[ENCODER_LPF_CUTOFF_OR_OSC_WAVE]);
-    // encoders[OSC_FREQ_ENC].callback(encoders[OSC_FREQ_ENC]);
+    (void)k_mutex_unlock(&render_lock);
 }
 
-int16_t Synthesizer::compute_sample(KeyPress &key) {
-    int16_t sample = 0;
-    auto freq      = (float)key.k.freq_millihz() / 1000;
+SYNTH_HOT_CODE int Synthesizer::synthesize(int16_t *const block, k_timeout_t timeout) {
+    const k_timepoint_t deadline = sys_timepoint_calc(timeout);
 
-    switch (current_mode) {
-        case OSC1:
-        case OSC2:
-            // Obtain sound frequency.
-            freq *= osc[current_mode].get_freq_shift();
-
-            // Calculate current key phase to select correct oscillator sample value
-            key.phase[current_mode] += freq * 0x10000 / Audio::SAMPLING_FREQUENCY;
-            sample = osc[current_mode].compute_sample(key.phase[current_mode]);
-            break;
-        case MASTER:
-            return 0;
-        default:
-            __unreachable();
+    // Offline renders keep the lock past the deadline, silence goes out meanwhile.
+    if (k_mutex_lock(&render_lock, sys_timepoint_timeout(deadline)) < 0) {
+        return -ETIMEDOUT;
     }
 
-    return sample;
+    apply_pending_preset();
+    Wavetable::swap();
+
+    const int ret = render(block, keypresses, true, deadline);
+    if (ret == -ETIMEDOUT) {
+        (void)atomic_inc(&overruns);
+    }
+
+    (void)k_mutex_unlock(&render_lock);
+
+    return ret;
 }
 
-int Synthesizer::synthesize(int16_t *const block, k_timeout_t timeout) {
-    k_timepoint_t deadline = sys_timepoint_calc(timeout);
+void Synthesizer::begin_offline(void) {
+    (void)k_mutex_lock(&render_lock, K_FOREVER);
+}
 
-    // NOTE: We don't care about stereo, so send same data to both channels.
-    for (unsigned int i = 0; i < Audio::SAMPLES_PER_BLOCK; i += Audio::CHANNEL_COUNT) {
-        int16_t sample = 0;
+void Synthesizer::end_offline(void) {
+    (void)k_mutex_unlock(&render_lock);
+}
+
+int Synthesizer::render_offline(int16_t *const block, KeyPress *const keys,
+                                const Preset &preset) {
+    // The caller holds the render lock, so the audio thread never renders with
+    // these parameters.
+    const Preset live = current_preset();
+    apply_preset(clamp_preset(preset));
+
+    const int ret = render(block, keys, false, sys_timepoint_calc(K_FOREVER));
+
+    apply_preset(live);
+
+    return ret;
+}
+
+uint32_t Synthesizer::get_overruns(void) {
+    return atomic_get(&overruns);
+}
+
+SYNTH_HOT_CODE int Synthesizer::render(int16_t *const block, KeyPress *const keys,
+                                       const bool with_percussion,
+                                       const k_timepoint_t deadline) {
+    // The pitch and gains of the playing keys hold for the whole block.
+    unsigned int voice_count = 0;
+    for (unsigned int j = 0; j < MAX_KEYPRESSES; ++j) {
+        if (keys[j].state != KeyPress::PRESSED) {
+            continue;
+        }
+
+        if (sys_timepoint_expired(keys[j].hold_time)) {
+            keys[j].state = KeyPress::IDLE;
+        } else {
+            prepare_voice(keys[j], voice_mode, unison, detune, &voices[voice_count++]);
+        }
+    }
+
+    // A whole block of noise at once, cheaper than a few frames of a voice.
+    Noise::fill(noise_block, FRAME_COUNT);
+
+    const bool has_percussion = with_percussion && !Percussion::is_idle();
+    if (has_percussion) {
+        Percussion::render(percussion_block, noise_block, FRAME_COUNT);
+    }
+
+#ifdef CONFIG_SYNTH_GAIN_RAMP
+    // The codec volume moves by 0.5 dB per step. Ramp across the block to the
+    // gain which makes up for the steps it has yet to take.
+    const int steps           = CLAMP(master_volume - Audio::get_codec_volume(),
+                                      -GAIN_MAX_STEPS, GAIN_MAX_STEPS);
+    const int32_t target_gain = powf(10, steps / 40.0f) * 0x8000;
+    const int32_t gain_step   = (target_gain - gain) / (int32_t)FRAME_COUNT;
+#endif  // CONFIG_SYNTH_GAIN_RAMP
 
-        if (sys_timepoint_expired(deadline)) {
+    // Interleaved frames, left channel first.
+    for (unsigned int i = 0; i < Audio::SAMPLES_PER_BLOCK; i += Audio::CHANNEL_COUNT) {
+        // Reading the clock every frame would cost more than some voices.
+        if (i % (DEADLINE_CHECK_FRAMES * Audio::CHANNEL_COUNT) == 0 &&
+            sys_timepoint_expired(deadline)) {
             return -ETIMEDOUT;
         }
 
-        // Get the synthesized sound for every pressed key
-        for (unsigned int j = 0; j < MAX_KEYPRESSES; ++j) {
-            if (keypresses[j].state == KeyPress::PRESSED &&
-                !sys_timepoint_expired(keypresses[j].hold_time)) {
-                sample += compute_sample(keypresses[j]);
-            } else if (keypresses[j].state == KeyPress::PRESSED &&
-                       sys_timepoint_expired(keypresses[j].hold_time)) {
-                keypresses[j].state = KeyPress::IDLE;
-            }
+        const unsigned int n = i / Audio::CHANNEL_COUNT;
+
+        int32_t frame[Audio::CHANNEL_COUNT] = {};
+        for (unsigned int j = 0; j < voice_count; ++j) {
+            render_voice(voices[j], noise_block[n], frame);
+        }
+
+        if (has_percussion) {
+            frame[0] += percussion_block[n];
+            frame[1] += percussion_block[n];
         }
 
+#ifdef CONFIG_SYNTH_GAIN_RAMP
+        gain += gain_step;
+#endif  // CONFIG_SYNTH_GAIN_RAMP
+
         for (unsigned int j = 0; j < Audio::CHANNEL_COUNT; ++j) {
+            int32_t sample = CLAMP(frame[j], INT16_MIN, INT16_MAX);
+#ifdef CONFIG_SYNTH_GAIN_RAMP
+            sample = CLAMP(sample * gain >> 15, INT16_MIN, INT16_MAX);
+#endif  // CONFIG_SYNTH_GAIN_RAMP
             block[i + j] = sample;
         }
     }
 
+#ifdef CONFIG_SYNTH_GAIN_RAMP
+    // Drop the rounding error of the steps.
+    gain = target_gain;
+#endif  // CONFIG_SYNTH_GAIN_RAMP
+
     return 0;
 }
@@ -1,10 +1,16 @@
 #pragma once
 
 #include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/sys_clock.h>
 
 #include "KeyPress.hpp"
+#include "Preset.hpp"
+#include "Synthesizer/Key.hpp"
 #include "Synthesizer/Oscillator.hpp"
+#include "Synthesizer/Percussion.hpp"
+#include "Synthesizer/sample_bank.h"
 
 class Synthesizer {
    public:
@@ -22,11 +28,54 @@ class Synthesizer {
         SPECIAL,
     } Effect;
 
+    // How the two oscillators of a voice combine.
+    typedef enum {
+        // OSC1 and OSC2 mixed.
+        DUAL,
+        // OSC2 modulates the phase of OSC1.
+        FM,
+        // OSC2 modulates the amplitude of OSC1.
+        RING,
+        // The selected sample bank, at the OSC1 pitch and volume.
+        SAMPLE,
+
+        VOICE_MODE_COUNT,
+    } VoiceMode;
+
+    // FM index at which the modulator sweeps the carrier phase by a full period.
+    static constexpr uint8_t MOD_INDEX_PER_PERIOD = 8;
+    static constexpr uint8_t MAX_MOD_INDEX        = 32;
+
+    // Detune of the outermost unison copies, in cents either way.
+    static constexpr uint8_t MAX_DETUNE = 50;
+
    private:
     static uint8_t master_volume;
     static Oscillator osc[2];
     static Mode current_mode;
     static Effect current_effect;
+    static VoiceMode voice_mode;
+    static uint8_t mod_index;
+    static uint8_t unison;
+    static uint8_t detune;
+    static uint8_t sample;
+    // Pitch bend as a 16.16 fixed-point factor.
+    static uint32_t pitch_bend;
+    // Recalled preset, applied by the audio thread at the next block boundary.
+    static Preset pending_preset;
+    static bool has_pending_preset;
+    static struct k_spinlock preset_lock;
+    // Held while a block renders, and by offline renders for as long as they run.
+    static struct k_mutex render_lock;
+    static atomic_t overruns;
+
+    static Preset current_preset(void);
+    static Preset clamp_preset(const Preset &preset);
+    // Apply a clamped preset, bar the master volume and the effect.
+    static void apply_preset(const Preset &preset);
+    static void apply_pending_preset(void);
+    static int render(int16_t *block, KeyPress *keys, bool with_percussion,
+                      k_timepoint_t deadline);
 
    public:
     // Disallow creating an instance of this class.
@@ -39,9 +88,86 @@ class Synthesizer {
     static void set_mode(Mode oscillator);
     static void set_effect(Effect effect);
 
-    static void change_waveform(bool must_increase);
-    static void change_pitch(bool must_increase);
-    static void change_volume(bool must_increase);
+    /// @brief Encoder handlers, applying a whole batch of steps at once
+    /// @param delta accumulated encoder steps, positive when clockwise
+    static void change_waveform(int delta);
+    static void change_pitch(int delta);
+    static void change_volume(int delta);
+
+    /// @brief Switch an oscillator to a user wavetable
+    /// @param oscillator OSC1 or OSC2
+    /// @param slot the wavetable slot, below Wavetable::SLOT_COUNT
+    static void use_wavetable(Mode oscillator, uint8_t slot);
+
+    /// @brief Start playing a key, or retrigger it if it is already playing
+    /// @param key the key to play
+    /// @param velocity strength of the key press, up to MAX_VELOCITY
+    /// @param hold_time time after which the key is released, K_FOREVER to wait
+    /// for note_off()
+    /// @return 0 on success, -ENOMEM if every voice is in use
+    static int note_on(Key key, uint8_t velocity, k_timeout_t hold_time);
+
+    /// @brief Release a playing key
+    /// @param key the key to release
+    static void note_off(Key key);
+
+    /// @brief Release every playing key and stop the percussion
+    static void all_notes_off(void);
+
+    /// @brief Play a percussion sound on top of the keys
+    /// @param sound the sound to play
+    /// @param velocity strength of the hit, up to MAX_VELOCITY
+    /// @return 0 on success, -EINVAL if the sound is unknown
+    static int hit(Percussion::Sound sound, uint8_t velocity);
+
+    /// @brief Bend the pitch of every key
+    /// @param bend bend from -8192 to 8191, spanning two semitones each way
+    static void set_pitch_bend(int16_t bend);
+
+    /// @brief Stack detuned copies of OSC1 on every voice
+    /// The copies are spread evenly over the detune range and panned from left
+    /// to right.
+    /// @param voices number of copies, from 1 to MAX_UNISON, 1 turning unison off
+    /// @param detune detune of the outermost copies in cents, up to MAX_DETUNE
+    static void set_unison(uint8_t voices, uint8_t detune);
+
+    /// @brief Select the sample bank played in the SAMPLE voice mode
+    /// @param index bank index, below Sampler::count()
+    /// @return 0 on success, -EINVAL if there is no such bank
+    static int set_sample(uint8_t index);
+
+    /// @brief Set the master volume
+    /// @param volume volume value, from 0 to 255
+    static void set_master_volume(uint8_t volume);
+
+    /// @brief Check whether any voice is playing
+    /// Voices whose hold time is over are released on the way.
+    /// @return true if every voice is idle
+    static bool is_idle(void);
+
+    /// @brief Check whether any voice is playing, without releasing any
+    /// Safe to call from any thread.
+    /// @return true if a key or a percussion sound is playing
+    static bool is_playing(void);
+
+    /// @brief Block until a note is played, returning right away if one is
+    static void wait_for_note(void);
+
+    /// @brief Take a snapshot of every parameter
+    /// @param preset the snapshot
+    static void get_preset(Preset *preset);
+
+    /// @brief Recall a snapshot of every parameter
+    /// The oscillators switch over at the next block boundary, never within a
+    /// block.
+    /// @param preset the snapshot, ignored if its version does not match
+    static void recall(const Preset &preset);
+
+    /// @brief Apply the recalled preset and swap committed wavetables in
+    /// synthesize() does so first. Call it where no block renders, e.g. while
+    /// idle, so that they do not wait for the next note. Does nothing while a
+    /// block renders, which applies them itself.
+    static void apply_pending(void);
 
     /// @brief Populate the audio buffer with sound
     /// @param block the audio block
@@ -49,8 +175,64 @@ class Synthesizer {
     /// @return 0 on success, otherwise ERRNO
     static int synthesize(int16_t *block, k_timeout_t timeout);
 
-    /// @brief Compute next sound value for a specific key
+    /// @brief Take the rendering over from the audio thread
+    /// Until end_offline(), only the calling thread may render blocks, and the
+    /// audio thread waits. Hold it for a block at a time, or the audio thread
+    /// times out and plays silence instead.
+    static void begin_offline(void);
+
+    /// @brief Hand the rendering back to the audio thread
+    static void end_offline(void);
+
+    /// @brief Render a block of keys and parameters of the caller's own
+    /// Call between begin_offline() and end_offline(). The live keys, percussion
+    /// and parameters are left alone, and the render is never timed out.
+    /// @param block the audio block
+    /// @param keys MAX_KEYPRESSES keys, played in place of the live ones
+    /// @param preset parameters for this block only, the master volume and the
+    /// effect excepted
+    /// @return 0 on success, otherwise ERRNO
+    static int render_offline(int16_t *block, KeyPress *keys, const Preset &preset);
+
+    /// @brief Get the number of blocks which missed their render deadline
+    /// @return overrun count since boot
+    static uint32_t get_overruns(void);
+
+    /// @brief Rendering state of a playing key, fixed for a block
+    struct Voice {
+        KeyPress *key;
+        VoiceMode mode;
+        int32_t mod_index;
+        // Phase increment of each oscillator.
+        uint32_t increment[2];
+        // Q15 gain of each oscillator, including the key velocity.
+        int32_t gain[2];
+        // Number of OSC1 copies, 1 when unison is off.
+        uint8_t unison;
+        // Phase increment of each OSC1 copy.
+        uint32_t unison_increment[MAX_UNISON];
+        // Q15 left and right gains of the OSC1 copies, packed two copies per
+        // word for the dual multiply-accumulate.
+        uint32_t unison_gain[2][MAX_UNISON / 2];
+        // Sample bank and step through it in 32.32 fixed point, SAMPLE mode only.
+        const struct sample_bank *bank;
+        uint64_t sample_step;
+    };
+
+    /// @brief Compute the rendering state of a key for the next block
+    /// The oscillators, the pitch bend, the modulation index and the sample bank
+    /// are the engine's own.
     /// @param key the key you want to generate sound with
-    /// @return the next sound value
-    static int16_t compute_sample(KeyPress &key);
+    /// @param mode how the two oscillators combine
+    /// @param unison_count number of OSC1 copies, 1 to MAX_UNISON
+    /// @param detune_cents spread of the copies either way
+    /// @param voice the rendering state
+    static void prepare_voice(KeyPress &key, VoiceMode mode, uint8_t unison_count,
+                              uint8_t detune_cents, Voice *voice);
+
+    /// @brief Compute the next stereo frame of a voice from both oscillators
+    /// @param voice the rendering state from prepare_voice()
+    /// @param noise white noise sample of the frame
+    /// @param frame left and right sums to add the voice to
+    static void render_voice(Voice &voice, int16_t noise, int32_t frame[2]);
 };
@@ -1,85 +1,109 @@
 #include "Key.hpp"
 
+#include <errno.h>
 #include <stdint.h>
 
-static const uint32_t KEY_FREQ_MAP[Key::COUNT] = {
-    [Key::A3] = 200000,  [Key::BB3] = 233080, [Key::B3] = 246940,  [Key::C3] = 261626,
-    [Key::CH3] = 277183, [Key::D3] = 293665,  [Key::DH3] = 311127, [Key::E3] = 329628,
-    [Key::F3] = 349228,  [Key::FH3] = 369994, [Key::G3] = 391995,  [Key::AB3] = 415305,
-    [Key::A4] = 440000,  [Key::BB4] = 466164, [Key::B4] = 493883,  [Key::C4] = 523251,
+#include "../Audio.hpp"
+#include "../placement.h"
 
-    [Key::CH4] = 0,      [Key::D4] = 0,       [Key::DH4] = 0,      [Key::E4] = 0,
+constexpr uint8_t MIDI_NOTE_A3 = 57;
+constexpr uint8_t MIDI_NOTE_A4 = 69;
+constexpr uint8_t MIDI_NOTE_C4 = 60;
+
+// 12-TET ratio between two adjacent notes, 2^(1/12).
+constexpr double SEMITONE_RATIO = 1.0594630943592952646;
+
+struct PhaseIncrementTable {
+    uint32_t increment[Key::COUNT];
 };
 
+static constexpr PhaseIncrementTable make_phase_increment_table(void) {
+    PhaseIncrementTable table{};
+
+    for (unsigned int note = 0; note < Key::COUNT; ++note) {
+        double freq = 440;
+        for (unsigned int i = note; i > MIDI_NOTE_A4; --i) {
+            freq *= SEMITONE_RATIO;
+        }
+        for (unsigned int i = note; i < MIDI_NOTE_A4; ++i) {
+            freq /= SEMITONE_RATIO;
+        }
+
+        table.increment[note] =
+            (uint32_t)(freq * 4294967296.0 / Audio::SAMPLING_FREQUENCY + 0.5);
+    }
+
+    return table;
+}
+
+static constexpr PhaseIncrementTable PHASE_INCREMENTS SYNTH_DSP_TABLE =
+    make_phase_increment_table();
+
 /*
- *  s d   g h j
- * z x c v b n m ,
- * | | | | | | | |
- * C D E F G A B C
+ *  w e   t y u   o p
+ * a s d f g h j k l ;
+ * | | | | | | | | | |
+ * C D E F G A B C D E
  */
-Key::Key(char ch) {
-    switch (ch) {
-        case ';':
-            key = E4;
-            break;
-        case 'p':
-            key = DH4;
-            break;
-        case 'l':
-            key = D4;
-            break;
-        case 'o':
-            key = CH4;
-            break;
-        case 'k':
-            key = C4;
-            break;
-        case 'j':
-            key = B4;
-            break;
-        case 'u':
-            key = BB4;
-            break;
-        case 'h':
-            key = A4;
-            break;
-        case 'y':
-            key = AB3;
-            break;
-        case 'g':
-            key = G3;
-            break;
-        case 't':
-            key = FH3;
-            break;
-        case 'f':
-            key = F3;
-            break;
-        case 'd':
-            key = E3;
-            break;
-        case 'e':
-            key = DH3;
-            break;
-        case 's':
-            key = D3;
-            break;
-        case 'w':
-            key = CH3;
-            break;
-        case 'a':
-            key = C3;
-            break;
-        default:
-            key = A3;
-            break;
+constexpr char KEYMAP[] = "awsedftgyhujkolp;";
+
+// Marks characters that are not part of the keymap.
+constexpr int8_t NO_NOTE = INT8_MIN;
+
+struct CharTable {
+    // Semitones from C4.
+    int8_t offset[UINT8_MAX + 1];
+};
+
+static constexpr CharTable make_char_table(void) {
+    CharTable table{};
+
+    for (auto& offset : table.offset) {
+        offset = NO_NOTE;
+    }
+    for (unsigned int i = 0; KEYMAP[i] != '\0'; ++i) {
+        table.offset[(uint8_t)KEYMAP[i]] = i;
     }
+
+    return table;
+}
+
+static constexpr CharTable CHAR_TO_NOTE = make_char_table();
+
+Key::Key(void) : note(MIDI_NOTE_A3) {}
+
+int Key::from_char(const char ch, const int8_t octave, Key* const key) {
+    const int8_t offset = CHAR_TO_NOTE.offset[(uint8_t)ch];
+    if (offset == NO_NOTE) {
+        return -EINVAL;
+    }
+
+    const int note = MIDI_NOTE_C4 + 12 * octave + offset;
+    if (note < 0 || note >= (int)COUNT) {
+        return -EINVAL;
+    }
+
+    key->note = note;
+    return 0;
+}
+
+int Key::from_midi(const uint8_t note, Key* const key) {
+    if (note >= COUNT) {
+        return -EINVAL;
+    }
+
+    key->note = note;
+    return 0;
+}
+
+uint8_t Key::midi_note(void) const {
+    return this->note;
 }
 
-bool Key::operator==(const Key& other) {
-    return this->key == other.key;
+SYNTH_HOT_CODE uint32_t Key::phase_increment(void) const {
+    return PHASE_INCREMENTS.increment[this->note];
 }
 
-uint32_t Key::freq_millihz() {
-    return KEY_FREQ_MAP[this->key];
+bool Key::operator==(const Key& other) const {
+    return this->note == other.note;
 }
@@ -4,42 +4,39 @@
 
 class Key {
    private:
-    unsigned int key;
+    uint8_t note;
 
    public:
-    enum {
-        A3,
-        BB3,
-        B3,
-        C3,
-        CH3,
-        D3,
-        DH3,
-        E3,
-        F3,
-        FH3,
-        G3,
-        AB3,
-        A4,
-        BB4,
-        B4,
-        C4,
-        CH4,
-        D4,
-        DH4,
-        E4,
-
-        COUNT,
-    };
+    /// @brief Number of MIDI notes covered by the key table.
+    static constexpr unsigned int COUNT = 128;
+
+    /// @brief Generate the A3 key
+    Key(void);
 
     /// @brief Generate Key from keyboard input
-    /// @param c the keyboard input
-    /// @return keyboard key
-    Key(char ch);
+    /// The keymap spans C4 (`a`) to E5 (`;`) on the home row, shifted by whole octaves.
+    /// @param ch the keyboard input
+    /// @param octave octaves to shift the keymap by
+    /// @param key the generated key
+    /// @return 0 on success, -EINVAL if the character is not mapped or the shifted
+    /// note is out of range
+    static int from_char(char ch, int8_t octave, Key* key);
+
+    /// @brief Generate Key from a MIDI note number
+    /// @param note MIDI note number, 69 being A4
+    /// @param key the generated key
+    /// @return 0 on success, -EINVAL if the note is out of range
+    static int from_midi(uint8_t note, Key* key);
+
+    /// @brief Get the MIDI note number of this key
+    /// @return MIDI note number
+    uint8_t midi_note(void) const;
 
-    /// @brief Get the frequency associated with this key in millihertz.
-    /// @return frequency in millihertz
-    uint32_t freq_millihz(void);
+    /// @brief Get the per-sample phase increment of this key
+    /// A full period spans the whole 32-bit range, so the upper 16 bits of the
+    /// accumulated phase are the 16-bit phase the oscillators expect.
+    /// @return phase increment at Audio::SAMPLING_FREQUENCY
+    uint32_t phase_increment(void) const;
 
-    bool operator==(const Key& other);
+    bool operator==(const Key& other) const;
 };
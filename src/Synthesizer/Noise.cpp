@@ -0,0 +1,24 @@
+#include "Noise.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../placement.h"
+
+// Any seed but zero, which the generator never leaves.
+uint32_t Noise::state = 0x2545f491;
+
+SYNTH_HOT_CODE void Noise::fill(int16_t* const buffer, const size_t count) {
+    uint32_t* const words = reinterpret_cast<uint32_t*>(buffer);
+    uint32_t x            = state;
+
+    // Shifts and XORs only, both halves of each word make a sample.
+    for (size_t i = 0; i < (count + 1) / 2; ++i) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        words[i] = x;
+    }
+
+    state = x;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief White noise from a xorshift32 generator
+/// Every step of the generator yields two samples, written as a single word.
+class Noise {
+   private:
+    static uint32_t state;
+
+   public:
+    // Disallow creating an instance of this class.
+    Noise() = delete;
+
+    /// @brief Fill a buffer with full-scale white noise
+    /// @param buffer the buffer, aligned on 4 bytes
+    /// @param count number of samples, rounded up to an even number
+    static void fill(int16_t* buffer, size_t count);
+};
@@ -6,23 +6,48 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "../placement.h"
+#include "Wavetable.hpp"
 #include "sine.h"
 
-constexpr auto MAX_VOLUME = 100;
-
-static const float SHIFT_FREQUENCIES[] = {
+static constexpr float SHIFT_FREQUENCIES[] = {
     0.250, 0.265, 0.281, 0.297, 0.315, 0.334, 0.354, 0.375, 0.397, 0.420, 0.445, 0.472, 0.500,
     0.530, 0.561, 0.595, 0.630, 0.667, 0.707, 0.749, 0.794, 0.841, 0.891, 0.944, 1.000, 1.059,
     1.122, 1.189, 1.260, 1.335, 1.414, 1.498, 1.587, 1.682, 1.782, 1.888, 2.000, 2.119, 2.245,
     2.378, 2.520, 2.670, 2.828, 2.997, 3.175, 3.364, 3.564, 3.775, 4.000};
 
-Oscillator::Oscillator(void) : wave(WaveType::SQUARE), volume(10), freq_shift_index(24) {}
+static_assert(ARRAY_SIZE(SHIFT_FREQUENCIES) == Oscillator::SHIFT_COUNT,
+              "SHIFT_COUNT must match the shift table");
+
+struct PhaseShiftTable {
+    uint32_t shift[ARRAY_SIZE(SHIFT_FREQUENCIES)];
+};
+
+static constexpr PhaseShiftTable make_phase_shift_table(void) {
+    PhaseShiftTable table{};
+
+    for (size_t i = 0; i < ARRAY_SIZE(SHIFT_FREQUENCIES); ++i) {
+        table.shift[i] = (uint32_t)(SHIFT_FREQUENCIES[i] * 0x10000 + 0.5f);
+    }
+
+    return table;
+}
+
+// SHIFT_FREQUENCIES as 16.16 fixed-point factors.
+static constexpr PhaseShiftTable PHASE_SHIFTS SYNTH_DSP_TABLE = make_phase_shift_table();
+
+Oscillator::Oscillator(void)
+    : wave(WaveType::SQUARE), volume(10), freq_shift_index(24), table(0) {}
 
 float Oscillator::get_freq_shift(void) {
     return SHIFT_FREQUENCIES[this->freq_shift_index];
 }
 
-int16_t Oscillator::compute_sample(const uint16_t phase) {
+SYNTH_HOT_CODE uint32_t Oscillator::get_phase_shift(void) {
+    return PHASE_SHIFTS.shift[this->freq_shift_index];
+}
+
+SYNTH_HOT_CODE int16_t Oscillator::waveform(const uint16_t phase, const int16_t noise) {
     int16_t sample;
 
     switch (this->wave) {
@@ -39,31 +64,63 @@ int16_t Oscillator::compute_sample(const uint16_t phase) {
         case SAWTOOTH:
             sample = phase - 0x8000;
             break;
+        case NOISE:
+            sample = noise;
+            break;
+        case USER:
+            sample = Wavetable::lookup(this->table, phase);
+            break;
 
         default:
             __unreachable();
     }
 
-    return (int32_t)sample * this->volume / MAX_VOLUME;
+    return sample;
+}
+
+int16_t Oscillator::compute_sample(const uint16_t phase, const int16_t noise) {
+    return (int32_t)this->waveform(phase, noise) * this->volume / MAX_VOLUME;
+}
+
+int32_t Oscillator::get_gain(void) {
+    return (int32_t)this->volume * 0x8000 / MAX_VOLUME;
+}
+
+Oscillator::Settings Oscillator::get_settings(void) {
+    return Settings{
+        .wave       = (uint8_t)this->wave,
+        .volume     = this->volume,
+        .freq_shift = (uint8_t)this->freq_shift_index,
+        .table      = this->table,
+    };
+}
+
+void Oscillator::set_settings(const Settings &settings) {
+    this->wave             = static_cast<WaveType>(MIN(settings.wave, WaveType::COUNT - 1));
+    this->volume           = MIN(settings.volume, MAX_VOLUME);
+    this->freq_shift_index = MIN(settings.freq_shift, ARRAY_SIZE(SHIFT_FREQUENCIES) - 1);
+    this->table            = MIN(settings.table, Wavetable::SLOT_COUNT - 1);
+}
+
+void Oscillator::set_table(const uint8_t slot) {
+    this->wave  = WaveType::USER;
+    this->table = MIN(slot, Wavetable::SLOT_COUNT - 1);
 }
 
-Oscillator::WaveType Oscillator::change_waveform(const bool must_increase) {
-    const unsigned int delta = must_increase ? 1 : WaveType::COUNT - 1;
-    this->wave = static_cast<WaveType>((static_cast<unsigned int>(this->wave) + delta) %
-                                       WaveType::COUNT);
+Oscillator::WaveType Oscillator::change_waveform(const int delta) {
+    const int wave = ((int)this->wave + delta) % WaveType::COUNT;
+    this->wave     = static_cast<WaveType>(wave < 0 ? wave + WaveType::COUNT : wave);
 
     return this->wave;
 }
 
-void Oscillator::change_pitch(const bool must_increase) {
-    const int8_t delta = must_increase ? 1 : -1;
+void Oscillator::change_pitch(const int delta) {
     this->freq_shift_index =
         CLAMP((int32_t)this->freq_shift_index + delta, 0, ARRAY_SIZE(SHIFT_FREQUENCIES) - 1);
 }
 
-uint16_t Oscillator::change_volume(const bool must_increase) {
-    const int8_t delta = must_increase ? 2 : -2;
-    this->volume       = CLAMP((int16_t)this->volume + delta, 0, MAX_VOLUME);
+uint16_t Oscillator::change_volume(const int delta) {
+    this->volume = CLAMP((int32_t)this->volume + delta * 2, 0, MAX_VOLUME);
 
     return this->volume;
 }
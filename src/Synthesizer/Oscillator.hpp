@@ -10,26 +10,80 @@ class Oscillator {
         TRIANGLE,
         SQUARE,
         SAWTOOTH,
+        NOISE,
+        // Wavetable uploaded into a RAM slot.
+        USER,
 
         COUNT,
     } WaveType;
 
+    /// @brief Persistent oscillator parameters
+    struct Settings {
+        uint8_t wave;
+        uint8_t volume;
+        uint8_t freq_shift;
+        uint8_t table;
+    };
+
+    static constexpr uint8_t MAX_VOLUME = 100;
+    // Number of frequency shifts, from two octaves down to two octaves up.
+    static constexpr uint8_t SHIFT_COUNT = 49;
+
    private:
     WaveType wave;
     uint8_t volume;
     size_t freq_shift_index;
+    uint8_t table;
 
    public:
     Oscillator(void);
 
     float get_freq_shift(void);
 
+    /// @brief Get the frequency shift as a fixed-point factor
+    /// @return frequency shift, 0x10000 being no shift
+    uint32_t get_phase_shift(void);
+
     /// @brief Compute the oscillator output sample
     /// @param phase the current phase to generate sample with
+    /// @param noise white noise sample of the current frame, see waveform()
     /// @return the next oscillator sample
-    int16_t compute_sample(uint16_t phase);
+    int16_t compute_sample(uint16_t phase, int16_t noise);
+
+    /// @brief Compute the full-scale waveform, leaving the volume to the caller
+    /// @param phase the current phase to generate sample with
+    /// @param noise white noise sample of the current frame, which the NOISE
+    /// waveform passes through as it is
+    /// @return the waveform sample
+    int16_t waveform(uint16_t phase, int16_t noise);
+
+    /// @brief Get the volume as a gain
+    /// @return Q15 gain, 0x8000 being full scale
+    int32_t get_gain(void);
+
+    /// @brief Get the current parameters
+    /// @return the oscillator settings
+    Settings get_settings(void);
+
+    /// @brief Apply parameters, clamping out-of-range values
+    /// @param settings the oscillator settings
+    void set_settings(const Settings &settings);
+
+    /// @brief Play a user wavetable
+    /// @param slot the wavetable slot, below Wavetable::SLOT_COUNT
+    void set_table(uint8_t slot);
+
+    /// @brief Step through the waveforms, wrapping around
+    /// @param delta number of waveforms to move by, negative to go back
+    /// @return the new waveform
+    WaveType change_waveform(int delta);
+
+    /// @brief Step through the frequency shifts, saturating at both ends
+    /// @param delta number of shifts to move by, negative to go down
+    void change_pitch(int delta);
 
-    WaveType change_waveform(bool must_increase);
-    void change_pitch(bool must_increase);
-    uint16_t change_volume(bool must_increase);
+    /// @brief Change the volume by two units per step, saturating at both ends
+    /// @param delta number of steps to move by, negative to go down
+    /// @return the new volume
+    uint16_t change_volume(int delta);
 };
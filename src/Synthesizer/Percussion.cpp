@@ -0,0 +1,162 @@
+#include "Percussion.hpp"
+
+#include <errno.h>
+#include <math.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../Audio.hpp"
+#include "../KeyPress.hpp"
+#include "../placement.h"
+#include "sine.h"
+
+struct SoundParams {
+    // The sine drops from start_freq to end_freq with a pitch_ms time constant.
+    float start_freq;
+    float end_freq;
+    float pitch_ms;
+    // Peak level and time constant of each part.
+    float tone_level;
+    float tone_ms;
+    float noise_level;
+    float noise_ms;
+};
+
+// The levels of each sound add up to less than 2, so the mix cannot overflow.
+static constexpr SoundParams SOUNDS[Percussion::Sound::COUNT] = {
+    [Percussion::Sound::KICK]  = {150, 45, 30, 1.0, 150, 0.15, 5},
+    [Percussion::Sound::SNARE] = {220, 180, 20, 0.5, 60, 0.7, 80},
+    [Percussion::Sound::HIHAT] = {0, 0, 1, 0, 1, 0.5, 25},
+};
+
+// Envelopes below this level are silent once scaled down to Q15.
+constexpr int32_t SILENT = 1 << 15;
+
+Percussion::Hit Percussion::hits[] SYNTH_VOICE_STATE;
+unsigned int Percussion::next_hit;
+Percussion::Hit Percussion::queued_hits[];
+unsigned int Percussion::queued_count;
+bool Percussion::stop_requested;
+struct k_spinlock Percussion::lock;
+
+// Per-frame Q32 factor of an exponential decay.
+static uint32_t decay_factor(const float time_constant_ms) {
+    const float factor = expf(-1000 / (time_constant_ms * Audio::SAMPLING_FREQUENCY));
+
+    return MIN(factor * 4294967296.0f, (float)UINT32_MAX);
+}
+
+// Phase increment of a frequency, a full period spanning the whole 32-bit range.
+static uint32_t frequency_increment(const float freq) {
+    return freq * 4294967296.0f / Audio::SAMPLING_FREQUENCY;
+}
+
+int Percussion::trigger(const Sound sound, const uint8_t velocity) {
+    if (sound >= Sound::COUNT) {
+        return -EINVAL;
+    }
+
+    const SoundParams &params = SOUNDS[sound];
+    const float level         = (float)(MIN(velocity, MAX_VELOCITY) + 1) / (MAX_VELOCITY + 1);
+
+    Hit hit;
+    hit.active           = true;
+    hit.phase            = 0;
+    hit.base_increment   = frequency_increment(params.end_freq);
+    hit.excess_increment = frequency_increment(params.start_freq) - hit.base_increment;
+    hit.tone             = params.tone_level * level * (1 << 30);
+    hit.noise            = params.noise_level * level * (1 << 30);
+    hit.pitch_decay      = decay_factor(params.pitch_ms);
+    hit.tone_decay       = decay_factor(params.tone_ms);
+    hit.noise_decay      = decay_factor(params.noise_ms);
+
+    const k_spinlock_key_t key = k_spin_lock(&lock);
+    if (queued_count < MAX_HITS) {
+        queued_hits[queued_count++] = hit;
+    }
+    k_spin_unlock(&lock, key);
+
+    return 0;
+}
+
+void Percussion::stop(void) {
+    const k_spinlock_key_t key = k_spin_lock(&lock);
+    stop_requested             = true;
+    queued_count               = 0;
+    k_spin_unlock(&lock, key);
+}
+
+void Percussion::start_queued(void) {
+    const k_spinlock_key_t key = k_spin_lock(&lock);
+    if (stop_requested) {
+        for (unsigned int i = 0; i < MAX_HITS; ++i) {
+            hits[i].active = false;
+        }
+        stop_requested = false;
+    }
+
+    for (unsigned int i = 0; i < queued_count; ++i) {
+        hits[next_hit] = queued_hits[i];
+        next_hit       = (next_hit + 1) % MAX_HITS;
+    }
+    queued_count = 0;
+    k_spin_unlock(&lock, key);
+}
+
+bool Percussion::is_idle(void) {
+    if (queued_count != 0) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < MAX_HITS; ++i) {
+        if (hits[i].active) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+SYNTH_HOT_CODE void Percussion::render(int16_t *const block, const int16_t *const noise,
+                                       const size_t count) {
+    start_queued();
+
+    for (size_t i = 0; i < count; ++i) {
+        block[i] = 0;
+    }
+
+    for (unsigned int j = 0; j < MAX_HITS; ++j) {
+        Hit &hit = hits[j];
+        if (!hit.active) {
+            continue;
+        }
+
+        // Work on copies, multiplies and shifts only.
+        uint32_t phase  = hit.phase;
+        uint32_t excess = hit.excess_increment;
+        int32_t tone    = hit.tone;
+        int32_t hiss    = hit.noise;
+        for (size_t i = 0; i < count; ++i) {
+            phase += hit.base_increment + excess;
+
+            const int32_t sine = (int32_t)SINE_LUT[phase >> 22] + INT16_MIN;
+            const int32_t mix  = sine * (tone >> 15) + noise[i] * (hiss >> 15);
+            block[i]           = CLAMP(block[i] + (mix >> 15), INT16_MIN, INT16_MAX);
+
+            excess = (uint64_t)excess * hit.pitch_decay >> 32;
+            tone   = (int64_t)tone * hit.tone_decay >> 32;
+            hiss   = (int64_t)hiss * hit.noise_decay >> 32;
+        }
+
+        hit.phase            = phase;
+        hit.excess_increment = excess;
+        hit.tone             = tone;
+        hit.noise            = hiss;
+        if (tone < SILENT && hiss < SILENT) {
+            hit.active = false;
+        }
+    }
+}
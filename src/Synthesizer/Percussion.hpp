@@ -0,0 +1,74 @@
+#pragma once
+
+#include <zephyr/spinlock.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Percussion voices: a noise burst over a sine dropping in pitch
+/// Each part fades out exponentially. The hits play on top of the keys, in
+/// their own slots.
+class Percussion {
+   public:
+    typedef enum {
+        KICK,
+        SNARE,
+        HIHAT,
+
+        COUNT,
+    } Sound;
+
+    /// @brief Maximum number of hits playing at once. Space allocated at compile time.
+    static constexpr unsigned int MAX_HITS = 4;
+
+   private:
+    struct Hit {
+        bool active;
+        uint32_t phase;
+        // Sine phase increment the pitch drops to.
+        uint32_t base_increment;
+        // Phase increment above the base, shrinking every frame.
+        uint32_t excess_increment;
+        // Q30 envelopes of the sine and of the noise.
+        int32_t tone;
+        int32_t noise;
+        // Per-frame Q32 factors of the pitch drop and of both envelopes.
+        uint32_t pitch_decay;
+        uint32_t tone_decay;
+        uint32_t noise_decay;
+    };
+
+    static Hit hits[MAX_HITS];
+    static unsigned int next_hit;
+    // Hits triggered since the last block, started by the audio thread.
+    static Hit queued_hits[MAX_HITS];
+    static unsigned int queued_count;
+    static bool stop_requested;
+    static struct k_spinlock lock;
+
+    static void start_queued(void);
+
+   public:
+    // Disallow creating an instance of this class.
+    Percussion() = delete;
+
+    /// @brief Start a hit at the next block, taking over the oldest slot if every
+    /// one is in use
+    /// @param sound the sound to play
+    /// @param velocity strength of the hit, up to MAX_VELOCITY
+    /// @return 0 on success, -EINVAL if the sound is unknown
+    static int trigger(Sound sound, uint8_t velocity);
+
+    /// @brief Stop every hit at the next block
+    static void stop(void);
+
+    /// @brief Check whether any hit is playing
+    /// @return true if every hit has faded out
+    static bool is_idle(void);
+
+    /// @brief Render the hits, mono
+    /// @param block the output, one sample per frame
+    /// @param noise white noise, one sample per frame
+    /// @param count number of frames
+    static void render(int16_t* block, const int16_t* noise, size_t count);
+};
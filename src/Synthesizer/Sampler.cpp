@@ -0,0 +1,79 @@
+#include "Sampler.hpp"
+
+#include <zephyr/sys/iterable_sections.h>
+#include <zephyr/sys/util.h>
+
+#include <cstdint>
+
+#include "../Audio.hpp"
+#include "../placement.h"
+#include "Key.hpp"
+#include "sample_bank.h"
+
+unsigned int Sampler::count(void) {
+    int count;
+
+    STRUCT_SECTION_COUNT(sample_bank, &count);
+    return count;
+}
+
+const struct sample_bank *Sampler::get(const unsigned int index) {
+    struct sample_bank *bank;
+
+    if (index >= count()) {
+        return nullptr;
+    }
+
+    STRUCT_SECTION_GET(sample_bank, index, &bank);
+    return bank;
+}
+
+uint64_t Sampler::step(const struct sample_bank &bank, const uint32_t increment) {
+    Key root;
+
+    if (Key::from_midi(bank.root_note, &root) < 0) {
+        return 0;
+    }
+
+    // The ratio of the phase increments is the pitch ratio to the root note.
+    const float ratio = (float)bank.rate / Audio::SAMPLING_FREQUENCY * increment /
+                        root.phase_increment();
+
+    return ratio * 4294967296.0f;
+}
+
+SYNTH_HOT_CODE uint64_t Sampler::advance(const struct sample_bank &bank, uint64_t position,
+                                         const uint64_t step) {
+    position += step;
+    if ((position >> 32) < bank.length || bank.loop_start >= bank.length) {
+        return position;
+    }
+
+    // A single division, even when a short loop is stepped over many times.
+    const uint64_t loop_start  = (uint64_t)bank.loop_start << 32;
+    const uint64_t loop_length = (uint64_t)(bank.length - bank.loop_start) << 32;
+    return loop_start + (position - loop_start) % loop_length;
+}
+
+SYNTH_HOT_CODE int16_t Sampler::interpolate(const struct sample_bank &bank,
+                                            const uint64_t position) {
+    // The guard samples around the data cover x[-1] to x[2].
+    const int16_t *const x = &bank.data[position >> 32];
+    // Q15 fraction between x[0] and x[1].
+    const int32_t t = (uint32_t)position >> 17;
+
+#ifdef CONFIG_SYNTH_SAMPLE_INTERPOLATION_CUBIC
+    // Catmull-Rom spline, with doubled coefficients to stay in integers.
+    const int32_t c1 = x[1] - x[-1];
+    const int32_t c2 = 2 * x[-1] - 5 * x[0] + 4 * x[1] - x[2];
+    const int32_t c3 = 3 * (x[0] - x[1]) + x[2] - x[-1];
+
+    int64_t y = (int64_t)c3 * t >> 15;
+    y         = (y + c2) * t >> 15;
+    y         = (y + c1) * t >> 15;
+
+    return CLAMP(x[0] + (y >> 1), INT16_MIN, INT16_MAX);
+#else
+    return x[0] + ((x[1] - x[0]) * t >> 15);
+#endif  // CONFIG_SYNTH_SAMPLE_INTERPOLATION_CUBIC
+}
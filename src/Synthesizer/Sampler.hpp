@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+#include "sample_bank.h"
+
+/// @brief Playback of the sample banks linked into the firmware
+/// Samples are read in place through the memory-mapped flash: the data cache
+/// of the ART accelerator fetches 128-bit lines, eight samples at a time, and
+/// serves as the read-ahead cache of the sequential reads.
+class Sampler {
+   public:
+    // Disallow creating an instance of this class.
+    Sampler() = delete;
+
+    /// @brief Get the number of linked banks
+    /// @return number of banks
+    static unsigned int count(void);
+
+    /// @brief Get a bank
+    /// @param index bank index, below count()
+    /// @return the bank, nullptr if the index is out of range
+    static const struct sample_bank *get(unsigned int index);
+
+    /// @brief Get the step through a bank playing a key
+    /// @param bank the bank
+    /// @param increment phase increment of the key, bends and shifts included
+    /// @return step per output sample, in 32.32 fixed-point samples
+    static uint64_t step(const struct sample_bank &bank, uint32_t increment);
+
+    /// @brief Step through a bank
+    /// Looping banks wrap back into their loop, however many times the step spans
+    /// it. One-shot banks run past their length.
+    /// @param bank the bank
+    /// @param position current position in 32.32 fixed-point samples
+    /// @param step step from step()
+    /// @return the next position
+    static uint64_t advance(const struct sample_bank &bank, uint64_t position, uint64_t step);
+
+    /// @brief Interpolate a bank between samples
+    /// Linear or cubic, depending on CONFIG_SYNTH_SAMPLE_INTERPOLATION.
+    /// @param bank the bank
+    /// @param position position in 32.32 fixed-point samples, below the length
+    /// @return the interpolated sample
+    static int16_t interpolate(const struct sample_bank &bank, uint64_t position);
+};
@@ -0,0 +1,111 @@
+#include "Wavetable.hpp"
+
+#include <errno.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../placement.h"
+
+// One buffer per slot, plus the spare one.
+static int16_t buffers[Wavetable::SLOT_COUNT + 1][Wavetable::MAX_LENGTH] SYNTH_VOICE_STATE;
+
+Wavetable::State Wavetable::state;
+Wavetable::Table Wavetable::tables[];
+int16_t *Wavetable::spare;
+uint8_t Wavetable::upload_slot;
+uint16_t Wavetable::upload_length;
+uint16_t Wavetable::received;
+uint32_t Wavetable::expected_crc;
+uint32_t Wavetable::crc;
+struct k_spinlock Wavetable::lock;
+
+// Shift from a 16-bit phase to an index into a table of a given length.
+static uint8_t phase_shift(const uint16_t length) {
+    return 16 - LOG2(length);
+}
+
+void Wavetable::init(void) {
+    for (unsigned int i = 0; i < SLOT_COUNT; ++i) {
+        tables[i] = {
+            .samples = buffers[i],
+            .shift   = phase_shift(MAX_LENGTH),
+        };
+    }
+    spare = buffers[SLOT_COUNT];
+    state = IDLE;
+}
+
+int Wavetable::begin(const uint8_t slot, const uint16_t length, const uint32_t checksum) {
+    if (slot >= SLOT_COUNT || length < 2 || length > MAX_LENGTH || !IS_POWER_OF_TWO(length)) {
+        return -EINVAL;
+    }
+
+    const k_spinlock_key_t key = k_spin_lock(&lock);
+    if (state == COMMITTED) {
+        k_spin_unlock(&lock, key);
+        return -EBUSY;
+    }
+    state = RECEIVING;
+    k_spin_unlock(&lock, key);
+
+    upload_slot   = slot;
+    upload_length = length;
+    received      = 0;
+    expected_crc  = checksum;
+    crc           = 0;
+
+    return 0;
+}
+
+int Wavetable::write(const uint16_t offset, const uint8_t *const data, const size_t size) {
+    const size_t count = size / sizeof(int16_t);
+
+    if (state != RECEIVING || offset != received || size % sizeof(int16_t) != 0 ||
+        count > upload_length - received) {
+        return -EINVAL;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        spare[received + i] = sys_get_le16(&data[i * sizeof(int16_t)]);
+    }
+    crc       = crc32_ieee_update(crc, data, size);
+    received += count;
+
+    return 0;
+}
+
+int Wavetable::commit(void) {
+    if (state != RECEIVING || received != upload_length) {
+        return -EINVAL;
+    }
+
+    if (crc != expected_crc) {
+        state = IDLE;
+        return -EBADMSG;
+    }
+
+    const k_spinlock_key_t key = k_spin_lock(&lock);
+    state                      = COMMITTED;
+    k_spin_unlock(&lock, key);
+
+    return upload_slot;
+}
+
+void Wavetable::swap(void) {
+    const k_spinlock_key_t key = k_spin_lock(&lock);
+    if (state == COMMITTED) {
+        Table &table           = tables[upload_slot];
+        int16_t *const samples = spare;
+
+        spare         = table.samples;
+        table.samples = samples;
+        table.shift   = phase_shift(upload_length);
+        state         = IDLE;
+    }
+    k_spin_unlock(&lock, key);
+}
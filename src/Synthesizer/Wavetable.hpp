@@ -0,0 +1,84 @@
+#pragma once
+
+#include <zephyr/spinlock.h>
+#include <zephyr/toolchain.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief User wavetables uploaded at runtime into RAM slots
+/// An upload fills a spare buffer, which the audio thread swaps with the slot's
+/// buffer at the next block boundary. Playing oscillators are never read from a
+/// half-written table, and nothing is allocated.
+class Wavetable {
+   public:
+    static constexpr unsigned int SLOT_COUNT = 4;
+    // Samples of the longest table, matching the sine table.
+    static constexpr unsigned int MAX_LENGTH = 1024;
+
+   private:
+    struct Table {
+        int16_t *samples;
+        // Shift from a 16-bit phase to a sample index.
+        uint8_t shift;
+    };
+
+    typedef enum {
+        IDLE,
+        RECEIVING,
+        // Waiting for the audio thread to swap the buffers.
+        COMMITTED,
+    } State;
+
+    static State state;
+    static Table tables[SLOT_COUNT];
+    // Buffer receiving the next upload.
+    static int16_t *spare;
+    static uint8_t upload_slot;
+    static uint16_t upload_length;
+    static uint16_t received;
+    static uint32_t expected_crc;
+    static uint32_t crc;
+    static struct k_spinlock lock;
+
+   public:
+    // Disallow creating an instance of this class.
+    Wavetable() = delete;
+
+    /// @brief Wavetable initialization function
+    /// Every slot starts out silent.
+    static void init(void);
+
+    /// @brief Start an upload, dropping any unfinished one
+    /// @param slot slot to load, below SLOT_COUNT
+    /// @param length number of samples, a power of two up to MAX_LENGTH
+    /// @param checksum CRC-32 (IEEE) of the samples as little-endian bytes
+    /// @return 0 on success, -EINVAL on invalid arguments, -EBUSY if the last
+    /// upload is not swapped in yet
+    static int begin(uint8_t slot, uint16_t length, uint32_t checksum);
+
+    /// @brief Receive the next samples of the upload
+    /// @param offset index of the first sample, following the last received one
+    /// @param data little-endian 16-bit samples
+    /// @param size size of the data in bytes
+    /// @return 0 on success, -EINVAL if no upload is running, the offset is not
+    /// the expected one or the data overflows the table
+    static int write(uint16_t offset, const uint8_t *data, size_t size);
+
+    /// @brief Finish the upload, swapping the table in at the next block boundary
+    /// @return the loaded slot on success, -EINVAL if no upload is running or
+    /// samples are missing, -EBADMSG on a checksum mismatch
+    static int commit(void);
+
+    /// @brief Swap a committed upload in, from the audio thread between blocks
+    static void swap(void);
+
+    /// @brief Get the sample of a table at a phase
+    /// @param slot the slot, below SLOT_COUNT
+    /// @param phase the 16-bit phase
+    /// @return the sample
+    static ALWAYS_INLINE int16_t lookup(const uint8_t slot, const uint16_t phase) {
+        const Table &table = tables[slot];
+        return table.samples[phase >> table.shift];
+    }
+};
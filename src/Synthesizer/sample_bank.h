@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/sys/iterable_sections.h>
+
+/// @brief PCM sample played straight from flash
+/// Banks are generated from WAV files by scripts/wav2bank.py. The data holds
+/// one guard sample before index 0 and two after the last sample, so that the
+/// interpolation never has to check the bounds: the first samples of the loop
+/// for looping banks, silence otherwise.
+struct sample_bank {
+    const char *name;
+    // Mono 16-bit samples, guard samples excluded.
+    const int16_t *data;
+    uint32_t length;
+    // First sample of the loop, which ends at the last sample. Equal to length
+    // for one-shot samples.
+    uint32_t loop_start;
+    // Sampling rate in Hz.
+    uint32_t rate;
+    // MIDI note the sample plays at its own rate.
+    uint8_t root_note;
+};
+
+/// @brief Register a sample bank
+/// @param _name bank name, a C identifier
+/// @param _data sample array, guard samples included
+/// @param _loop_start first sample of the loop, the length for one-shot samples
+/// @param _rate sampling rate in Hz
+/// @param _root_note MIDI note the sample plays at its own rate
+#define SAMPLE_BANK_DEFINE(_name, _data, _loop_start, _rate, _root_note)                    \
+    const STRUCT_SECTION_ITERABLE(sample_bank, _name) = {                                   \
+        .name       = #_name,                                                               \
+        .data       = &(_data)[1],                                                          \
+        .length     = sizeof(_data) / sizeof((_data)[0]) - 3,                               \
+        .loop_start = (_loop_start),                                                        \
+        .rate       = (_rate),                                                              \
+        .root_note  = (_root_note),                                                         \
+    }
@@ -2,7 +2,9 @@
 
 #include <stdint.h>
 
-const uint16_t SINE_LUT[] = {
+#include "../placement.h"
+
+const uint16_t SINE_LUT[] SYNTH_DSP_TABLE = {
     0x8000, 0x80c9, 0x8192, 0x825b, 0x8324, 0x83ee, 0x84b7, 0x8580, 0x8649, 0x8712, 0x87db,
     0x88a4, 0x896c, 0x8a35, 0x8afe, 0x8bc6, 0x8c8e, 0x8d57, 0x8e1f, 0x8ee7, 0x8fae, 0x9076,
     0x913e, 0x9205, 0x92cc, 0x9393, 0x945a, 0x9521, 0x95e7, 0x96ad, 0x9773, 0x9839, 0x98fe,
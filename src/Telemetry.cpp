@@ -0,0 +1,131 @@
+#include "Telemetry.hpp"
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/kernel/thread_stack.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <cstdint>
+
+#include "Synthesizer.hpp"
+#include "Synthesizer/Oscillator.hpp"
+#include "Synthesizer/Sampler.hpp"
+#include "USB.hpp"
+
+static_assert(Telemetry::Param::COUNT * Synthesizer::Mode::COUNT <= ATOMIC_BITS,
+              "Dirty flags must fit a single atomic");
+
+K_THREAD_STACK_DEFINE(telemetry_stack, CONFIG_SYNTH_TELEMETRY_STACK_SIZE);
+
+struct k_thread Telemetry::thread;
+struct k_sem Telemetry::sem;
+atomic_t Telemetry::dirty;
+atomic_t Telemetry::values[];
+
+static const char *const MODE_STRING_MAP[Synthesizer::Mode::COUNT] = {
+    [Synthesizer::Mode::OSC1]   = "OSC1",
+    [Synthesizer::Mode::OSC2]   = "OSC2",
+    [Synthesizer::Mode::MASTER] = "MASTER",
+};
+
+static const char *const WAVETYPE_STRING_MAP[Oscillator::WaveType::COUNT] = {
+    [Oscillator::WaveType::SINE]     = "Sine",
+    [Oscillator::WaveType::TRIANGLE] = "Triangle",
+    [Oscillator::WaveType::SQUARE]   = "Square",
+    [Oscillator::WaveType::SAWTOOTH] = "Sawtooth",
+    [Oscillator::WaveType::NOISE]    = "Noise",
+    [Oscillator::WaveType::USER]     = "User wavetable",
+};
+
+static const char *const EFFECT_STRING_MAP[] = {
+    [Synthesizer::Effect::LFO_MOD] = "Configuring LFO modulator (not implemented)",
+    [Synthesizer::Effect::AMP_MOD] = "Configuring amplitude modulator (not implemented)",
+    [Synthesizer::Effect::SPECIAL] = "Configuring special effects (not implemented)",
+};
+
+static const char *const VOICE_MODE_STRING_MAP[Synthesizer::VoiceMode::VOICE_MODE_COUNT] = {
+    [Synthesizer::VoiceMode::DUAL]   = "Dual oscillator",
+    [Synthesizer::VoiceMode::FM]     = "FM",
+    [Synthesizer::VoiceMode::RING]   = "Ring modulation",
+    [Synthesizer::VoiceMode::SAMPLE] = "Sample",
+};
+
+void Telemetry::format(const Param param, const Synthesizer::Mode mode, const int32_t value) {
+    switch (param) {
+        case MODE:
+            USB::println("[%s] Configured", MODE_STRING_MAP[mode]);
+            break;
+        case EFFECT:
+            USB::println("%s", EFFECT_STRING_MAP[value]);
+            break;
+        case WAVEFORM:
+            USB::println("[%s] Waveform: %s", MODE_STRING_MAP[mode], WAVETYPE_STRING_MAP[value]);
+            break;
+        case PITCH:
+            USB::println("[%s] Pitch: x%d.%03d", MODE_STRING_MAP[mode], value / 1000,
+                         value % 1000);
+            break;
+        case VOLUME:
+            USB::println("[%s] Volume: %d", MODE_STRING_MAP[mode], value);
+            break;
+        case OCTAVE:
+            USB::println("Octave: %+d", value);
+            break;
+        case VOICE_MODE:
+            USB::println("[%s] Voice: %s", MODE_STRING_MAP[mode],
+                         VOICE_MODE_STRING_MAP[value]);
+            break;
+        case MOD_INDEX:
+            USB::println("[%s] Mod index: %d", MODE_STRING_MAP[mode], value);
+            break;
+        case UNISON:
+            USB::println("[%s] Unison: %d voices, %d cents", MODE_STRING_MAP[mode], value >> 8,
+                         value & 0xff);
+            break;
+        case SAMPLE:
+            USB::println("[%s] Sample: %s", MODE_STRING_MAP[mode], Sampler::get(value)->name);
+            break;
+        default:
+            __unreachable();
+    }
+}
+
+int Telemetry::init(void) {
+    k_sem_init(&sem, 0, 1);
+
+    (void)k_thread_create(
+        &thread, telemetry_stack, K_THREAD_STACK_SIZEOF(telemetry_stack),
+        [](void *_a, void *_b, void *_c) {
+            while (true) {
+                (void)k_sem_take(&sem, K_FOREVER);
+
+                const atomic_val_t pending = atomic_clear(&dirty);
+                for (unsigned int slot = 0; slot < SLOT_COUNT; ++slot) {
+                    if ((pending & BIT(slot)) == 0) {
+                        continue;
+                    }
+
+                    format(static_cast<Param>(slot / Synthesizer::Mode::COUNT),
+                           static_cast<Synthesizer::Mode>(slot % Synthesizer::Mode::COUNT),
+                           atomic_get(&values[slot]));
+                }
+
+                // Bound the console bandwidth, changes keep coalescing meanwhile.
+                k_msleep(CONFIG_SYNTH_TELEMETRY_PERIOD_MS);
+            }
+        },
+        nullptr, nullptr, nullptr, CONFIG_SYNTH_TELEMETRY_PRIORITY, 0, K_NO_WAIT);
+    (void)k_thread_name_set(&thread, "telemetry");
+
+    return 0;
+}
+
+void Telemetry::post(const Param param, const Synthesizer::Mode mode, const int32_t value) {
+    const unsigned int slot = param * Synthesizer::Mode::COUNT + mode;
+
+    (void)atomic_set(&values[slot], value);
+    (void)atomic_set_bit(&dirty, slot);
+    k_sem_give(&sem);
+}
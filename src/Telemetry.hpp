@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#include "Synthesizer.hpp"
+
+class Telemetry {
+   public:
+    typedef enum {
+        MODE,
+        EFFECT,
+        WAVEFORM,
+        PITCH,
+        VOLUME,
+        OCTAVE,
+        VOICE_MODE,
+        MOD_INDEX,
+        UNISON,
+        SAMPLE,
+
+        COUNT,
+    } Param;
+
+   private:
+    static constexpr unsigned int SLOT_COUNT = Param::COUNT * Synthesizer::Mode::COUNT;
+
+    static struct k_thread thread;
+    static struct k_sem sem;
+    static atomic_t dirty;
+    static atomic_t values[SLOT_COUNT];
+
+    static void format(Param param, Synthesizer::Mode mode, int32_t value);
+
+   public:
+    // Disallow creating an instance of this class.
+    Telemetry() = delete;
+
+    /// @brief Telemetry initialization function
+    /// Starts the low priority thread that formats the notifications.
+    /// @return 0 on success, -ERRNO otherwise
+    static int init(void);
+
+    /// @brief Notify a parameter change without formatting it
+    /// Only the latest value of each parameter is kept until the formatter thread
+    /// runs, so bursts of changes cost a single line on the console. Safe to call
+    /// from ISRs.
+    /// @param param the changed parameter
+    /// @param mode mode the parameter belongs to
+    /// @param value new value. Pitch shifts are in thousandths, unison settings
+    /// hold the copies above the detune in the low byte.
+    static void post(Param param, Synthesizer::Mode mode, int32_t value);
+};
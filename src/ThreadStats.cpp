@@ -0,0 +1,131 @@
+#include "ThreadStats.hpp"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/kernel/thread.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_core.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include <cstdint>
+
+LOG_MODULE_REGISTER(thread_stats, LOG_LEVEL_INF);
+
+struct k_work_delayable ThreadStats::dwork;
+struct k_mutex ThreadStats::lock;
+ThreadStats::Entry ThreadStats::entries[];
+unsigned int ThreadStats::entry_count;
+uint64_t ThreadStats::prev_total_cycles;
+
+void ThreadStats::collect(void) {
+    k_thread_runtime_stats_t total;
+    (void)k_thread_runtime_stats_all_get(&total);
+
+    k_mutex_lock(&lock, K_FOREVER);
+
+    uint64_t total_cycles = total.execution_cycles - prev_total_cycles;
+    prev_total_cycles     = total.execution_cycles;
+
+    for (unsigned int i = 0; i < entry_count; ++i) {
+        entries[i].is_alive = false;
+    }
+
+    // NOTE:
+    // Threads are matched by pointer so that the CPU share is computed over
+    // the last period only.
+    k_thread_foreach_unlocked(
+        [](const struct k_thread* const thread, void* const user_data) {
+            const uint64_t total_cycles = *static_cast<const uint64_t*>(user_data);
+
+            Entry* entry = nullptr;
+            for (unsigned int i = 0; i < entry_count; ++i) {
+                if (entries[i].thread == thread) {
+                    entry = &entries[i];
+                    break;
+                }
+            }
+
+            if (entry == nullptr) {
+                if (entry_count == MAX_THREADS) {
+                    LOG_WRN("Thread %p not tracked, table is full", thread);
+                    return;
+                }
+
+                entry  = &entries[entry_count++];
+                *entry = {.thread = thread, .stack_size = thread->stack_info.size};
+            }
+
+            struct k_thread* const mutable_thread = const_cast<struct k_thread*>(thread);
+
+            k_thread_runtime_stats_t stats;
+            (void)k_thread_runtime_stats_get(mutable_thread, &stats);
+
+            // A new thread created in the place of an exited one starts over.
+            if (stats.execution_cycles < entry->prev_cycles) {
+                entry->prev_cycles = 0;
+            }
+
+            const uint64_t cycles = stats.execution_cycles - entry->prev_cycles;
+            entry->prev_cycles    = stats.execution_cycles;
+            entry->cpu_permille   = total_cycles == 0 ? 0 : cycles * 1000 / total_cycles;
+            entry->name           = k_thread_name_get(mutable_thread);
+            entry->stack_size     = thread->stack_info.size;
+            entry->is_alive       = true;
+
+            size_t unused;
+            if (k_thread_stack_space_get(thread, &unused) == 0) {
+                entry->stack_unused = unused;
+            }
+        },
+        &total_cycles);
+
+    // Drop the threads which exited since the last period, e.g. main().
+    unsigned int alive_count = 0;
+    for (unsigned int i = 0; i < entry_count; ++i) {
+        if (entries[i].is_alive) {
+            entries[alive_count++] = entries[i];
+        }
+    }
+    entry_count = alive_count;
+
+    k_mutex_unlock(&lock);
+}
+
+int ThreadStats::init(void) {
+    k_mutex_init(&lock);
+
+    k_work_init_delayable(&dwork, [](struct k_work* const item) {
+        collect();
+        (void)k_work_schedule(k_work_delayable_from_work(item),
+                              K_MSEC(CONFIG_SYNTH_THREAD_STATS_PERIOD_MS));
+    });
+
+    const int ret = k_work_schedule(&dwork, K_NO_WAIT);
+    if (ret < 0) {
+        LOG_ERR("Failed to schedule statistics collection: %d", -ret);
+        return ret;
+    }
+
+    return 0;
+}
+
+void ThreadStats::print(const struct shell* const sh) {
+    k_mutex_lock(&lock, K_FOREVER);
+
+    shell_print(sh, "%-16s %7s %16s", "thread", "cpu", "stack used/size");
+    for (unsigned int i = 0; i < entry_count; ++i) {
+        const Entry* const entry = &entries[i];
+        const char* const name   = entry->name != nullptr && entry->name[0] != '\0'
+                                       ? entry->name
+                                       : "(unnamed)";
+
+        shell_print(sh, "%-16s %5u.%u%% %8u/%-7u", name, entry->cpu_permille / 10,
+                    entry->cpu_permille % 10, entry->stack_size - entry->stack_unused,
+                    entry->stack_size);
+    }
+
+    k_mutex_unlock(&lock);
+}
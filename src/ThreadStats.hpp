@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+
+class ThreadStats {
+   private:
+    /// @brief Maximum number of threads tracked. Space allocated at compile time.
+    static constexpr unsigned int MAX_THREADS = 16;
+
+    struct Entry {
+        const struct k_thread* thread;
+        const char* name;
+        uint64_t prev_cycles;
+        uint32_t cpu_permille;
+        size_t stack_size;
+        size_t stack_unused;
+        // Whether the thread was found by the last collection.
+        bool is_alive;
+    };
+
+    static struct k_work_delayable dwork;
+    static struct k_mutex lock;
+    static Entry entries[MAX_THREADS];
+    static unsigned int entry_count;
+    static uint64_t prev_total_cycles;
+
+    static void collect(void);
+
+   public:
+    // Disallow creating an instance of this class.
+    ThreadStats() = delete;
+
+    /// @brief Start collecting the thread statistics periodically
+    /// @return 0 on success, -ERRNO otherwise
+    static int init(void);
+
+    /// @brief Print the last collected statistics
+    /// @param sh shell to print to
+    static void print(const struct shell* sh);
+};
@@ -19,13 +19,24 @@
 
 #include <cstdint>
 
+#include "trace.h"
+
 LOG_MODULE_REGISTER(usb, LOG_LEVEL_INF);
 
-static uint8_t format_buffer[1024];
-static uint8_t rx_buffer[10];  // NOTE: Improbable to get faster input from a keyboard.
+// NOTE: Large enough to absorb a full-speed USB packet of pasted or scripted input.
+static uint8_t rx_buffer[256];
 static struct ring_buf rx_ringbuf;
-static const uint8_t* tx_buffer;
-static size_t tx_remaining_bytes;
+static K_SEM_DEFINE(rx_sem, 0, 1);
+
+constexpr uint32_t TX_BUFFER_SIZE = 1024;
+
+// Messages from every context are queued here and drained by the TX-ready interrupt. A
+// message is either queued whole or dropped, so concurrent prints never interleave.
+RING_BUF_DECLARE(tx_ringbuf, TX_BUFFER_SIZE);
+static struct k_spinlock tx_lock;
+
+static_assert(USB::MESSAGE_HEADROOM < TX_BUFFER_SIZE,
+              "Bulk writes must fit next to the message headroom");
 
 const struct device* USB::dev;
 
@@ -41,32 +52,66 @@ static void irq_handler(const struct device* const dev, void* const user_data) {
             // NOTE: This can not error since the same errors have been checked during init.
             received_bytes = uart_fifo_read(dev, buffer, sizeof(buffer));
             LOG_DBG("Received %u bytes", received_bytes);
+            SYNTH_TRACE("usb_rx", received_bytes, 0);
 
             const uint32_t buffered_bytes = ring_buf_put(&rx_ringbuf, buffer, received_bytes);
             if (buffered_bytes < received_bytes) {
                 LOG_ERR("Dropped %u bytes", received_bytes - buffered_bytes);
             }
         } while (received_bytes == sizeof(buffer));
+
+        k_sem_give(&rx_sem);
     }
 
     if (uart_irq_tx_ready(dev)) {
-        // NOTE: This can not error since the same errors have been checked during init.
-        const unsigned int bytes_sent = uart_fifo_fill(dev, tx_buffer, tx_remaining_bytes);
-        tx_buffer += bytes_sent;
-        tx_remaining_bytes -= bytes_sent;
+        const k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+        uint8_t* data;
+        uint32_t claimed_bytes;
+        int bytes_sent;
+        do {
+            claimed_bytes = ring_buf_get_claim(&tx_ringbuf, &data, UINT32_MAX);
+            if (claimed_bytes == 0) {
+                break;
+            }
 
-        if (tx_remaining_bytes == 0) {
+            // NOTE: This can not error since the same errors have been checked during init.
+            bytes_sent = uart_fifo_fill(dev, data, claimed_bytes);
+            (void)ring_buf_get_finish(&tx_ringbuf, bytes_sent);
+            SYNTH_TRACE("usb_tx_fill", bytes_sent, ring_buf_size_get(&tx_ringbuf));
+        } while ((uint32_t)bytes_sent == claimed_bytes);
+
+        if (ring_buf_is_empty(&tx_ringbuf)) {
             LOG_DBG("Everything sent, disable TX IRQ");
             uart_irq_tx_disable(dev);
         }
+
+        k_spin_unlock(&tx_lock, key);
     }
 }
 
-void USB::write(const uint8_t* const buffer, const uint32_t size) {
-    tx_buffer          = buffer;
-    tx_remaining_bytes = size;
+int USB::queue(const uint8_t* const buffer, const uint32_t size, const uint32_t headroom) {
+    SYNTH_TRACE("usb_tx", size, headroom);
+
+    const k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    if (ring_buf_space_get(&tx_ringbuf) < size + headroom) {
+        k_spin_unlock(&tx_lock, key);
+        return -ENOBUFS;
+    }
+    (void)ring_buf_put(&tx_ringbuf, buffer, size);
+    k_spin_unlock(&tx_lock, key);
 
     uart_irq_tx_enable(USB::dev);
+
+    return 0;
+}
+
+int USB::write(const uint8_t* const buffer, const uint32_t size) {
+    return queue(buffer, size, 0);
+}
+
+int USB::write_bulk(const uint8_t* const buffer, const uint32_t size) {
+    return queue(buffer, size, MESSAGE_HEADROOM);
 }
 
 int USB::init(const struct device* const dev) {
@@ -123,37 +168,56 @@ int USB::init(const struct device* const dev) {
     return 0;
 }
 
+int USB::wait_for_data(const k_timeout_t timeout) {
+    if (!ring_buf_is_empty(&rx_ringbuf)) {
+        return 0;
+    }
+
+    return k_sem_take(&rx_sem, timeout);
+}
+
 uint32_t USB::read(char* const data, const uint32_t size) {
     return ring_buf_get((struct ring_buf*)&rx_ringbuf, (uint8_t*)data, size);
 }
 
 int USB::print(const char* format, ...) {
+    char buffer[MAX_MESSAGE_LENGTH];
     va_list args;
     va_start(args, format);
 
-    const int count = vsnprintf((char*)format_buffer, sizeof(format_buffer), format, args);
-    write(format_buffer, count);
+    int count = vsnprintf(buffer, sizeof(buffer), format, args);
+    count     = CLAMP(count, 0, (int)sizeof(buffer) - 1);
 
     va_end(args);
 
+    const int ret = write((const uint8_t*)buffer, count);
+    if (ret < 0) {
+        return ret;
+    }
+
     return count;
 }
 
 int USB::println(const char* format, ...) {
+    char buffer[MAX_MESSAGE_LENGTH];
     va_list args;
     va_start(args, format);
 
-    int count = vsnprintf((char*)format_buffer, sizeof(format_buffer), format, args);
-
     constexpr char newline[]        = "\r\n";
     constexpr size_t newline_length = sizeof(newline) - 1;
-    const size_t suffix_length      = MIN(sizeof(format_buffer) - count, newline_length);
-    (void)memcpy(&format_buffer[count], newline, suffix_length);
-    count += suffix_length;
 
-    write(format_buffer, count);
+    // Leave room for the newline, truncating the message if needed.
+    int count = vsnprintf(buffer, sizeof(buffer) - newline_length, format, args);
+    count     = CLAMP(count, 0, (int)(sizeof(buffer) - newline_length - 1));
+    (void)memcpy(&buffer[count], newline, newline_length);
+    count += newline_length;
 
     va_end(args);
 
+    const int ret = write((const uint8_t*)buffer, count);
+    if (ret < 0) {
+        return ret;
+    }
+
     return count;
 }
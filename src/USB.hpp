@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <zephyr/device.h>
+#include <zephyr/kernel.h>
 #include <zephyr/sys/ring_buffer.h>
 
 #include <cstdint>
@@ -10,9 +11,15 @@ class USB {
    private:
     static const struct device* dev;
 
-    static void write(const uint8_t* const buffer, const uint32_t size);
+    static int queue(const uint8_t* buffer, uint32_t size, uint32_t headroom);
 
    public:
+    /// @brief Longest message print and println can format, including the newline.
+    static constexpr unsigned int MAX_MESSAGE_LENGTH = 128;
+
+    /// @brief Room in the TX queue that bulk writes leave to the messages.
+    static constexpr unsigned int MESSAGE_HEADROOM = 2 * MAX_MESSAGE_LENGTH;
+
     // Disallow creating an instance of this class.
     USB() = delete;
 
@@ -21,23 +28,46 @@ class USB {
     /// @return 0 on success, -ERRNO otherwise
     static int init(const struct device* dev);
 
+    /// @brief Block until received data is available to read
+    /// @param timeout time to wait for data
+    /// @return 0 when data is available, -EAGAIN on timeout
+    static int wait_for_data(k_timeout_t timeout);
+
     /// @brief Read data from the USB port
     /// @param data data pointer
     /// @param size size of the data pointer
     /// @return number of bytes read
     static uint32_t read(char* data, uint32_t size);
 
+    /// @brief Queue data for transmission without blocking
+    /// Safe to call from threads, work items and ISRs. The data is either queued
+    /// whole or not at all.
+    /// @param buffer data to send
+    /// @param size size of the data
+    /// @return 0 on success, -ENOBUFS if the TX queue is full
+    static int write(const uint8_t* buffer, uint32_t size);
+
+    /// @brief Queue bulk data for transmission without blocking
+    /// Like write(), but leaves MESSAGE_HEADROOM bytes of the TX queue free, so
+    /// that a stream of bulk data does not crowd the messages out.
+    /// @param buffer data to send
+    /// @param size size of the data
+    /// @return 0 on success, -ENOBUFS if the TX queue is full
+    static int write_bulk(const uint8_t* buffer, uint32_t size);
+
     /// @brief basic print function
-    /// Does not support floating point, does not print a new line
+    /// Does not support floating point, does not print a new line. Messages are
+    /// truncated to MAX_MESSAGE_LENGTH.
     /// @param format C standard string format
     /// @param variables to parse into the string
-    /// @return Number of bytes written
+    /// @return Number of bytes queued, -ENOBUFS if the TX queue is full
     static int print(const char* const format, ...);
 
     /// @brief basic println function
-    /// Does not support floating point, does print a new line
+    /// Does not support floating point, does print a new line. Messages are
+    /// truncated to MAX_MESSAGE_LENGTH.
     /// @param format C standard string format
     /// @param variables to parse into the string
-    /// @return Number of bytes written
+    /// @return Number of bytes queued, -ENOBUFS if the TX queue is full
     static int println(const char* const format, ...);
 };
@@ -0,0 +1,24 @@
+/* Generated by scripts/wav2bank.py from tone.wav, do not edit. */
+
+#include <stdint.h>
+
+#include "../Synthesizer/sample_bank.h"
+
+static const int16_t tone_data[] = {
+    0, 0, 16, 63, 141, 249, 386, 552, 745, 964, 1206, 1469,
+    1753, 2054, 2369, 2697, 3034, 3377, 3724, 4072, 4416, 4755, 5085, 5403,
+    5705, 5988, 6250, 6487, 6697, 6876, 7022, 7133, 7206, 7239, 7230, 7177,
+    7079, 6935, 6743, 6503, 6215, 5878, 5492, 5058, 4577, 4049, 3476, 2860,
+    2202, 1504, 769, 0, -801, -1629, -2483, -3357, -4249, -5154, -6067, -6985,
+    -7903, -8817, -9721, -10610, -11481, -12328, -12944, -13509, -14021, -14477, -14876, -15217,
+    -15497, -15717, -15874, -15968, -16000, -15968, -15874, -15717, -15497, -15217, -14876, -14477,
+    -14021, -13509, -12944, -12328, -11663, -10953, -10199, -9405, -8573, -7708, -6812, -5890,
+    -4944, -3979, -2998, -2005, -1005, 0, 1005, 2005, 2998, 3979, 4944, 5890,
+    6812, 7708, 8573, 9405, 10199, 10953, 11663, 12328, 12944, 13509, 14021, 14477,
+    14876, 15217, 15497, 15717, 15874, 15968, 16000, 15968, 15874, 15717, 15497, 15217,
+    14876, 14477, 14021, 13509, 12944, 12328, 11663, 10953, 10199, 9405, 8573, 7708,
+    6812, 5890, 4944, 3979, 2998, 2005, 1005, 0, -1005, -2005, -2998, -3979,
+    -4944, -5890, -6812, -7708, -8573, -9405, -10199, -10953, -11663, -12328, -12944,
+};
+
+SAMPLE_BANK_DEFINE(tone, tone_data, 64, 44100, 69);
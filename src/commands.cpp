@@ -0,0 +1,286 @@
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include "Benchmark.hpp"
+#include "Capture.hpp"
+#include "KeyPress.hpp"
+#include "Preset.hpp"
+#include "Presets.hpp"
+#include "Synthesizer.hpp"
+#include "Synthesizer/Oscillator.hpp"
+#include "Synthesizer/Sampler.hpp"
+#include "Synthesizer/Wavetable.hpp"
+#include "ThreadStats.hpp"
+
+// Engine parameter, read and written through a preset.
+struct Param {
+    const char* name;
+    uint8_t min;
+    uint8_t max;
+    uint8_t* (*field)(Preset& preset);
+};
+
+static const Param PARAMS[] = {
+    {"volume", 0, UINT8_MAX, [](Preset& p) { return &p.master_volume; }},
+    {"effect", 0, Synthesizer::Effect::SPECIAL, [](Preset& p) { return &p.effect; }},
+    {"voice-mode", 0, Synthesizer::VoiceMode::VOICE_MODE_COUNT - 1,
+     [](Preset& p) { return &p.voice_mode; }},
+    {"mod-index", 0, Synthesizer::MAX_MOD_INDEX, [](Preset& p) { return &p.mod_index; }},
+    {"unison", 1, MAX_UNISON, [](Preset& p) { return &p.unison; }},
+    {"detune", 0, Synthesizer::MAX_DETUNE, [](Preset& p) { return &p.detune; }},
+    // Checked against the number of banks, only known once linked.
+    {"sample", 0, UINT8_MAX, [](Preset& p) { return &p.sample; }},
+    {"osc1-wave", 0, Oscillator::WaveType::COUNT - 1,
+     [](Preset& p) { return &p.osc[0].wave; }},
+    {"osc1-volume", 0, Oscillator::MAX_VOLUME, [](Preset& p) { return &p.osc[0].volume; }},
+    {"osc1-pitch", 0, Oscillator::SHIFT_COUNT - 1,
+     [](Preset& p) { return &p.osc[0].freq_shift; }},
+    {"osc1-table", 0, Wavetable::SLOT_COUNT - 1, [](Preset& p) { return &p.osc[0].table; }},
+    {"osc2-wave", 0, Oscillator::WaveType::COUNT - 1,
+     [](Preset& p) { return &p.osc[1].wave; }},
+    {"osc2-volume", 0, Oscillator::MAX_VOLUME, [](Preset& p) { return &p.osc[1].volume; }},
+    {"osc2-pitch", 0, Oscillator::SHIFT_COUNT - 1,
+     [](Preset& p) { return &p.osc[1].freq_shift; }},
+    {"osc2-table", 0, Wavetable::SLOT_COUNT - 1, [](Preset& p) { return &p.osc[1].table; }},
+};
+
+// Blocks rendered per waveform and voice count by default.
+constexpr unsigned long BENCH_BLOCKS     = 10;
+constexpr unsigned long MAX_BENCH_BLOCKS = 1000;
+
+static const Param* find_param(const struct shell* sh, const char* name) {
+    for (const Param& param : PARAMS) {
+        if (strcmp(param.name, name) == 0) {
+            return &param;
+        }
+    }
+
+    shell_error(sh, "Unknown parameter: %s", name);
+    return nullptr;
+}
+
+static int cmd_get(const struct shell* sh, size_t argc, char** argv) {
+    Preset preset;
+    Synthesizer::get_preset(&preset);
+
+    if (argc < 2) {
+        for (const Param& param : PARAMS) {
+            shell_print(sh, "%-12s %u", param.name, *param.field(preset));
+        }
+        return 0;
+    }
+
+    const Param* const param = find_param(sh, argv[1]);
+    if (param == nullptr) {
+        return -EINVAL;
+    }
+
+    shell_print(sh, "%u", *param->field(preset));
+    return 0;
+}
+
+static int cmd_set(const struct shell* sh, size_t argc, char** argv) {
+    const Param* const param = find_param(sh, argv[1]);
+    if (param == nullptr) {
+        return -EINVAL;
+    }
+
+    char* end;
+    const unsigned long value = strtoul(argv[2], &end, 10);
+    if (*end != '\0' || value < param->min || value > param->max) {
+        shell_error(sh, "Invalid %s: %s (%u to %u)", param->name, argv[2], param->min,
+                    param->max);
+        return -EINVAL;
+    }
+
+    Preset preset;
+    Synthesizer::get_preset(&preset);
+
+    uint8_t* const field = param->field(preset);
+    if (field == &preset.sample && value >= Sampler::count()) {
+        shell_error(sh, "Invalid sample bank: %s (%u banks)", argv[2], Sampler::count());
+        return -EINVAL;
+    }
+    *field = value;
+
+    // Applied at the next block boundary, like a recalled preset.
+    Synthesizer::recall(preset);
+    return 0;
+}
+
+static int cmd_stats(const struct shell* sh, size_t argc, char** argv) {
+    unsigned int voices = 0;
+    for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
+        if (keypresses[i].state == KeyPress::PRESSED) {
+            ++voices;
+        }
+    }
+
+    shell_print(sh, "Voices playing:  %u of %u", voices, MAX_KEYPRESSES);
+    shell_print(sh, "Render overruns: %u", Synthesizer::get_overruns());
+#ifdef CONFIG_SYNTH_CAPTURE
+    shell_print(sh, "Capture drops:   %u", Capture::get_dropped());
+#endif  // CONFIG_SYNTH_CAPTURE
+    return 0;
+}
+
+#ifdef CONFIG_SYNTH_BENCH_COMMAND
+static int cmd_bench(const struct shell* sh, size_t argc, char** argv) {
+    unsigned long blocks = BENCH_BLOCKS;
+    if (argc > 1) {
+        char* end;
+        blocks = strtoul(argv[1], &end, 10);
+        if (*end != '\0' || blocks < 1 || blocks > MAX_BENCH_BLOCKS) {
+            shell_error(sh, "Invalid block count: %s (1 to %lu)", argv[1], MAX_BENCH_BLOCKS);
+            return -EINVAL;
+        }
+    }
+
+    Benchmark::render(sh, blocks);
+    return 0;
+}
+#endif  // CONFIG_SYNTH_BENCH_COMMAND
+
+static int cmd_unison(const struct shell* sh, size_t argc, char** argv) {
+    char* end;
+
+    const unsigned long voices = strtoul(argv[1], &end, 10);
+    if (*end != '\0' || voices < 1 || voices > MAX_UNISON) {
+        shell_error(sh, "Invalid voice count: %s (1 to %u)", argv[1], MAX_UNISON);
+        return -EINVAL;
+    }
+
+    unsigned long detune = Synthesizer::MAX_DETUNE / 2;
+    if (argc > 2) {
+        detune = strtoul(argv[2], &end, 10);
+        if (*end != '\0' || detune > Synthesizer::MAX_DETUNE) {
+            shell_error(sh, "Invalid detune: %s (0 to %u cents)", argv[2],
+                        Synthesizer::MAX_DETUNE);
+            return -EINVAL;
+        }
+    }
+
+    Synthesizer::set_unison(voices, detune);
+    return 0;
+}
+
+static int cmd_sample(const struct shell* sh, size_t argc, char** argv) {
+    if (argc < 2) {
+        for (unsigned int i = 0; i < Sampler::count(); ++i) {
+            const struct sample_bank* const bank = Sampler::get(i);
+            shell_print(sh, "%u: %s (%u samples at %u Hz%s)", i, bank->name, bank->length,
+                        bank->rate, bank->loop_start < bank->length ? ", looping" : "");
+        }
+        return 0;
+    }
+
+    char* end;
+    const unsigned long index = strtoul(argv[1], &end, 10);
+    if (*end != '\0' || Synthesizer::set_sample(MIN(index, UINT8_MAX)) < 0) {
+        shell_error(sh, "Invalid sample bank: %s (%u banks)", argv[1], Sampler::count());
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+#ifdef CONFIG_SYNTH_THREAD_STATS
+static int cmd_threads(const struct shell* sh, size_t argc, char** argv) {
+    ThreadStats::print(sh);
+    return 0;
+}
+#endif  // CONFIG_SYNTH_THREAD_STATS
+
+#ifdef CONFIG_SYNTH_PRESETS
+static int parse_slot(const struct shell* sh, const char* arg, unsigned int* slot) {
+    char* end;
+    const unsigned long value = strtoul(arg, &end, 10);
+    if (*end != '\0' || value >= Presets::SLOT_COUNT) {
+        shell_error(sh, "Invalid slot: %s (0 to %u)", arg, Presets::SLOT_COUNT - 1);
+        return -EINVAL;
+    }
+
+    *slot = value;
+    return 0;
+}
+
+static int cmd_preset_save(const struct shell* sh, size_t argc, char** argv) {
+    unsigned int slot;
+    int ret;
+
+    ret = parse_slot(sh, argv[1], &slot);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = Presets::save(slot);
+    if (ret == -EAGAIN) {
+        shell_error(sh, "Preset log full, stop playing to erase it");
+        return ret;
+    } else if (ret < 0) {
+        shell_error(sh, "Failed to save preset %u: %d", slot, -ret);
+        return ret;
+    }
+
+    return 0;
+}
+
+static int cmd_preset_load(const struct shell* sh, size_t argc, char** argv) {
+    unsigned int slot;
+    int ret;
+
+    ret = parse_slot(sh, argv[1], &slot);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = Presets::load(slot);
+    if (ret == -ENOENT) {
+        shell_error(sh, "Preset %u is empty", slot);
+        return ret;
+    } else if (ret < 0) {
+        shell_error(sh, "Failed to load preset %u: %d", slot, -ret);
+        return ret;
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+    preset_cmds,
+    SHELL_CMD_ARG(save, NULL, "Store the current state: save <slot>", cmd_preset_save, 2, 0),
+    SHELL_CMD_ARG(load, NULL, "Recall a stored state: load <slot>", cmd_preset_load, 2, 0),
+    SHELL_SUBCMD_SET_END);
+#endif  // CONFIG_SYNTH_PRESETS
+
+SHELL_STATIC_SUBCMD_SET_CREATE(synth_cmds,
+                               SHELL_COND_CMD_ARG(CONFIG_SYNTH_BENCH_COMMAND, bench, NULL,
+                                                  "Time offline renders: bench [<blocks>]",
+                                                  cmd_bench, 1, 1),
+                               SHELL_CMD_ARG(get, NULL,
+                                             "Print engine parameters: get [<param>]",
+                                             cmd_get, 1, 1),
+                               SHELL_CMD_ARG(set, NULL,
+                                             "Set an engine parameter: set <param> <value>",
+                                             cmd_set, 3, 0),
+                               SHELL_CMD(stats, NULL, "Voice, overrun and capture counts",
+                                         cmd_stats),
+                               SHELL_COND_CMD(CONFIG_SYNTH_PRESETS, preset, &preset_cmds,
+                                              "Preset storage", NULL),
+                               SHELL_CMD_ARG(sample, NULL,
+                                             "List or pick a sample bank: sample [<bank>]",
+                                             cmd_sample, 1, 1),
+                               SHELL_CMD_ARG(unison, NULL,
+                                             "Stack detuned OSC1 copies: unison <n> [<cents>]",
+                                             cmd_unison, 2, 1),
+                               SHELL_COND_CMD(CONFIG_SYNTH_THREAD_STATS, threads, NULL,
+                                              "Per-thread CPU usage and stack usage",
+                                              cmd_threads),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(synth, &synth_cmds, "Synthesizer commands", NULL);
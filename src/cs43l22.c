@@ -8,11 +8,13 @@
 #include <errno.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <zephyr/audio/codec.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/i2c.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(cirrus_cs43l22);
@@ -54,6 +56,12 @@ LOG_MODULE_REGISTER(cirrus_cs43l22);
 #define REG_STATUS                   0x2e
 #define REG_SPEAKER_STATUS           0x31
 
+/* Registers mirrored by the shadow cache, up to the last one */
+#define REG_COUNT (REG_SPEAKER_STATUS + 1)
+
+/* (datasheet) Memory Address Pointer: auto-increment for bursts */
+#define MAP_INCR 0x80
+
 /* (datasheet) 7.5.4 DAC Interface Format */
 #define DAC_IF_FORMAT_LEFT_JUSTIFIED  0
 #define DAC_IF_FORMAT_I2S             1
@@ -75,33 +83,64 @@ LOG_MODULE_REGISTER(cirrus_cs43l22);
 #define SPEAKER_B_MUTE    (1 << 5)
 #define SPEAKER_A_MUTE    (1 << 4)
 
-#define cs43l22_write(_i2c, _reg, _value) cs43l22_write_masked(_i2c, _reg, _value, 0xff)
-static inline int cs43l22_write_masked(const struct i2c_dt_spec *i2c, uint8_t reg,
-                                       uint8_t value, uint8_t mask) {
-    int ret;
-    uint8_t actual_value = 0;
-    if (mask != 0xff) {
-        ret = i2c_burst_read_dt(i2c, reg, &actual_value, 1);
+/* Time the soft ramp takes to mute from full volume, with some margin */
+#define SOFT_RAMP_MS 25
+
+struct cs43l22_config {
+    struct i2c_dt_spec i2c;
+    struct gpio_dt_spec reset_gpio;
+};
+
+struct cs43l22_data {
+    struct k_mutex lock;
+    /* Shadow of the control registers, indexed by address */
+    uint8_t regs[REG_COUNT];
+};
+
+/*
+ * Write adjacent registers in a single auto-incremented transaction. Nothing is
+ * sent if the shadow shows that they already hold the values.
+ */
+static int cs43l22_write_burst(const struct device *dev, uint8_t reg, const uint8_t *values,
+                               size_t count) {
+    const struct cs43l22_config *cfg = dev->config;
+    struct cs43l22_data *data        = dev->data;
+    int ret                          = 0;
+
+    k_mutex_lock(&data->lock, K_FOREVER);
+    if (memcmp(&data->regs[reg], values, count) != 0) {
+        ret = i2c_burst_write_dt(&cfg->i2c, count > 1 ? reg | MAP_INCR : reg, values, count);
         if (ret) {
-            LOG_ERR("Unable to get actual register value [%02X]", reg);
-            return ret;
+            LOG_ERR("Unable to write registers [%02X..%02X]", reg, reg + count - 1);
+        } else {
+            memcpy(&data->regs[reg], values, count);
         }
     }
-    actual_value = (actual_value & ~mask) | (value & mask);
-    return i2c_burst_write_dt(i2c, reg, &actual_value, 1);
+    k_mutex_unlock(&data->lock);
+
+    return ret;
 }
 
-#define cs43l22_power_down(_i2c) cs43l22_write(_i2c, REG_POWER_CTL_1, 0x01)
-#define cs43l22_power_up(_i2c)   cs43l22_write(_i2c, REG_POWER_CTL_1, 0x9e)
+/* Update the masked bits of a register from its shadow, without reading it */
+static int cs43l22_write_masked(const struct device *dev, uint8_t reg, uint8_t value,
+                                uint8_t mask) {
+    struct cs43l22_data *data = dev->data;
 
-struct cs43l22_config {
-    struct i2c_dt_spec i2c;
-    struct gpio_dt_spec reset_gpio;
-};
+    k_mutex_lock(&data->lock, K_FOREVER);
+    const uint8_t actual_value = (data->regs[reg] & ~mask) | (value & mask);
+    const int ret              = cs43l22_write_burst(dev, reg, &actual_value, 1);
+    k_mutex_unlock(&data->lock);
+
+    return ret;
+}
+
+#define cs43l22_write(_dev, _reg, _value) cs43l22_write_masked(_dev, _reg, _value, 0xff)
+
+#define cs43l22_power_down(_dev) cs43l22_write(_dev, REG_POWER_CTL_1, 0x01)
+#define cs43l22_power_up(_dev)   cs43l22_write(_dev, REG_POWER_CTL_1, 0x9e)
 
 static int cs43l22_configure(const struct device *dev, struct audio_codec_cfg *audiocfg) {
     uint8_t format, wordlen;
-    const struct cs43l22_config *cfg = dev->config;
 
     switch (audiocfg->dai_type) {
         case AUDIO_DAI_TYPE_I2S:
@@ -147,23 +186,33 @@ static int cs43l22_configure(const struct device *dev, struct audio_codec_cfg *a
         }
     }
 
-    cs43l22_power_down(&cfg->i2c);
+    cs43l22_power_down(dev);
     /* Headphones always on, speaker always off */
-    cs43l22_write(&cfg->i2c, REG_POWER_CTL_2, 0xaf);
+    cs43l22_write(dev, REG_POWER_CTL_2, 0xaf);
     /* Automatic clock detection */
-    cs43l22_write(&cfg->i2c, REG_CLOCKING_CTL, 0x80);
+    cs43l22_write(dev, REG_CLOCKING_CTL, 0x80);
     /* Slave mode, do not invert SCLK, disable DSP, requested frame format */
-    cs43l22_write_masked(&cfg->i2c, REG_INTERFACE_CTL_1, (format << 2) | wordlen, 0xdf);
+    cs43l22_write_masked(dev, REG_INTERFACE_CTL_1, (format << 2) | wordlen, 0xdf);
     /* Enable soft ramp for volume changes */
-    cs43l22_write(&cfg->i2c, REG_MISC_CTL, 0x02);
+    cs43l22_write(dev, REG_MISC_CTL, 0x02);
 
-    cs43l22_power_up(&cfg->i2c);
+    cs43l22_power_up(dev);
     return 0;
 }
 
-static void cs43l22_start_output(const struct device *dev) {}
+static void cs43l22_start_output(const struct device *dev) {
+    cs43l22_power_up(dev);
+    /* Unmute through the soft ramp */
+    cs43l22_write_masked(dev, REG_PLAYBACK_CTL_2, 0, HEADPHONES_A_MUTE | HEADPHONES_B_MUTE);
+}
 
-static void cs43l22_stop_output(const struct device *dev) {}
+static void cs43l22_stop_output(const struct device *dev) {
+    /* Ramp down before cutting the power so that it does not pop */
+    cs43l22_write_masked(dev, REG_PLAYBACK_CTL_2, HEADPHONES_A_MUTE | HEADPHONES_B_MUTE,
+                         HEADPHONES_A_MUTE | HEADPHONES_B_MUTE);
+    k_msleep(SOFT_RAMP_MS);
+    cs43l22_power_down(dev);
+}
 
 static int cs43l22_apply_properties(const struct device *dev) {
     return 0;
@@ -171,8 +220,6 @@ static int cs43l22_apply_properties(const struct device *dev) {
 
 static int cs43l22_set_property(const struct device *dev, audio_property_t property,
                                 audio_channel_t channel, audio_property_value_t val) {
-    const struct cs43l22_config *cfg = dev->config;
-
     if (property == AUDIO_PROPERTY_OUTPUT_MUTE) {
         uint8_t dac_channel_mute = 0;
         switch (channel) {
@@ -195,11 +242,17 @@ static int cs43l22_set_property(const struct device *dev, audio_property_t prope
             default:
                 return -ENOTSUP;
         }
-        return cs43l22_write_masked(&cfg->i2c, REG_PLAYBACK_CTL_2,
+        return cs43l22_write_masked(dev, REG_PLAYBACK_CTL_2,
                                     val.mute ? dac_channel_mute : 0, dac_channel_mute);
     } else if (property == AUDIO_PROPERTY_OUTPUT_VOLUME) {
-        uint8_t reg, volume_scaled;
+        uint8_t reg, volume_scaled[2];
+        size_t count = 1;
         switch (channel) {
+            case AUDIO_CHANNEL_ALL:
+                /* Both headphone channels in one burst */
+                reg   = REG_HEADPHONES_A_VOL;
+                count = 2;
+                break;
             case AUDIO_CHANNEL_SIDE_LEFT:
                 reg = REG_HEADPHONES_A_VOL;
                 break;
@@ -217,11 +270,12 @@ static int cs43l22_set_property(const struct device *dev, audio_property_t prope
         }
 
         if ((uint8_t)val.vol < 0xff) {
-            volume_scaled = (uint8_t)val.vol + 1;
+            volume_scaled[0] = (uint8_t)val.vol + 1;
         } else {
-            volume_scaled = 0x0;
+            volume_scaled[0] = 0x0;
         }
-        return cs43l22_write(&cfg->i2c, reg, volume_scaled);
+        volume_scaled[1] = volume_scaled[0];
+        return cs43l22_write_burst(dev, reg, volume_scaled, count);
     }
 
     return -ENOTSUP;
@@ -238,6 +292,9 @@ static const struct audio_codec_api cs43l22_api = {
 static int cs43l22_init(const struct device *dev) {
     uint8_t regval;
     const struct cs43l22_config *cfg = dev->config;
+    struct cs43l22_data *data        = dev->data;
+
+    k_mutex_init(&data->lock);
 
     int ret = gpio_pin_configure_dt(&cfg->reset_gpio, GPIO_OUTPUT_ACTIVE);
     if (ret) {
@@ -257,16 +314,27 @@ static int cs43l22_init(const struct device *dev) {
 
     LOG_DBG("Found CS43L22 (chip=%02X, rev=%c%d)", regval >> 3, 'A' + ((regval >> 1) & 3),
             regval & 1);
+
+    /* Fill the shadow with the reset values in a single transaction */
+    ret = i2c_burst_read_dt(&cfg->i2c, REG_ID | MAP_INCR, &data->regs[REG_ID],
+                            REG_COUNT - REG_ID);
+    if (ret) {
+        LOG_ERR("Unable to read registers");
+        return -EIO;
+    }
+
     return 0;
 }
 
-#define CS43L22_INIT(inst)                                                        \
-    static const struct cs43l22_config cs43l22_config_##inst = {                  \
-        .i2c        = I2C_DT_SPEC_INST_GET(inst),                                 \
-        .reset_gpio = GPIO_DT_SPEC_INST_GET(inst, reset_gpios),                   \
-    };                                                                            \
-                                                                                  \
-    DEVICE_DT_INST_DEFINE(inst, cs43l22_init, NULL, NULL, &cs43l22_config_##inst, \
-                          POST_KERNEL, CONFIG_AUDIO_CODEC_INIT_PRIORITY, &cs43l22_api);
+#define CS43L22_INIT(inst)                                                      \
+    static const struct cs43l22_config cs43l22_config_##inst = {                \
+        .i2c        = I2C_DT_SPEC_INST_GET(inst),                               \
+        .reset_gpio = GPIO_DT_SPEC_INST_GET(inst, reset_gpios),                 \
+    };                                                                          \
+    static struct cs43l22_data cs43l22_data_##inst;                             \
+                                                                                \
+    DEVICE_DT_INST_DEFINE(inst, cs43l22_init, NULL, &cs43l22_data_##inst,       \
+                          &cs43l22_config_##inst, POST_KERNEL,                  \
+                          CONFIG_AUDIO_CODEC_INIT_PRIORITY, &cs43l22_api);
 
 DT_INST_FOREACH_STATUS_OKAY(CS43L22_INIT)
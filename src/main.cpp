@@ -17,12 +17,17 @@
 #include <cstddef>
 
 #include "Audio.hpp"
-#include "KeyPress.hpp"
+#include "Benchmark.hpp"
+#include "Capture.hpp"
+#include "Keyboard.hpp"
+#include "Presets.hpp"
 #include "Synthesizer.hpp"
-#include "Synthesizer/Key.hpp"
+#include "Telemetry.hpp"
+#include "ThreadStats.hpp"
 #include "USB.hpp"
 #include "leds.h"
 #include "peripherals.hpp"
+#include "trace.h"
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
@@ -34,62 +39,67 @@ struct k_thread keyboard_thread;
 K_THREAD_STACK_DEFINE(synth_stack, STACK_SIZE);
 K_THREAD_STACK_DEFINE(keyboard_stack, STACK_SIZE);
 
-/// Function that checks key presses
-static void check_keyboard(void) {
-    char character;
-    while (USB::read(&character, 1) != 0) {
-        auto key         = Key(character);
-        bool key_pressed = false;
-        for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
-            if (key == keypresses[i].k && keypresses[i].state != KeyPress::IDLE) {
-                keypresses[i].state        = KeyPress::PRESSED;
-                keypresses[i].hold_time    = sys_timepoint_calc(K_MSEC(500));
-                keypresses[i].release_time = sys_timepoint_calc(K_MSEC(500));
-                key_pressed                = true;
-            }
-        }
-        // The second loop is necessary to avoid selecting an IDLE key when a
-        // PRESSED or RELEASED key is located further away on the array
-        if (!key_pressed) {
-            for (unsigned int i = 0; i < MAX_KEYPRESSES; ++i) {
-                if (keypresses[i].state == KeyPress::IDLE) {
-                    keypresses[i].k            = key;
-                    keypresses[i].state        = KeyPress::PRESSED;
-                    keypresses[i].hold_time    = sys_timepoint_calc(K_MSEC(500));
-                    keypresses[i].release_time = sys_timepoint_calc(K_MSEC(500));
-                    keypresses[i].phase[0]     = 0;
-                    keypresses[i].phase[1]     = 0;
-                    break;
-                }
-            }
-        }
-    }
-}
-
 static inline int prepare_buffer(const k_timeout_t alloc_timeout,
-                                 const k_timeout_t synth_timeout) {
+                                 const k_timeout_t synth_timeout, bool *const is_idle) {
     const auto block = Audio::get_block(alloc_timeout);
     if (block == nullptr) {
         return -ENOMEM;
     }
 
-    return Synthesizer::synthesize(block, synth_timeout);
+    // Silent blocks skip the render, which would apply these otherwise.
+    Synthesizer::apply_pending();
+
+    // Nothing to render, reuse the silence from last time when possible.
+    *is_idle = Synthesizer::is_idle();
+    if (*is_idle) {
+        Audio::clear_block();
+        return 0;
+    }
+
+    Audio::touch_block();
+    SYNTH_TRACE("render_start", 0, 0);
+    const int ret = Synthesizer::synthesize(block, synth_timeout);
+    SYNTH_TRACE("render_done", -ret, 0);
+
+    return ret;
 }
 
-static void synth_thread_func(void *arg1, void *arg2, void *arg3) {
+static int start_stream(void) {
+    bool is_idle;
+    int ret;
+
     // Fill the audio TX queue to ensure further allocs block until DMA free.
     for (unsigned int i = 0; i < Audio::BLOCK_COUNT; ++i) {
-        prepare_buffer(K_NO_WAIT, K_FOREVER);
-        Audio::write_block();
+        // Blocks dropped by a previous stop may take a moment to come back.
+        ret = prepare_buffer(K_MSEC(Audio::BLOCK_DURATION_MS), K_FOREVER, &is_idle);
+        if (ret == -ENOMEM) {
+            return ret;
+        }
+        if (ret < 0) {
+            // Start with silence rather than a partial block.
+            Audio::clear_block();
+        }
+
+        ret = Audio::write_block();
+        if (ret < 0) {
+            return ret;
+        }
     }
 
-    int ret = Audio::start_writes();
+    return Audio::start_writes();
+}
+
+static void synth_thread_func(void *arg1, void *arg2, void *arg3) {
+    int ret = start_stream();
     if (ret < 0) {
         LOG_ERR("Failed to start audio writes: %d", -ret);
         return;
     }
 
     bool overload_led_set = false;
+    bool is_idle;
+    k_timepoint_t power_down_time =
+        sys_timepoint_calc(K_MSEC(CONFIG_SYNTH_IDLE_POWER_DOWN_MS));
     while (true) {
         // NOTE:
         // Since the TX queue is filled at this point, this call will block
@@ -100,8 +110,9 @@ static void synth_thread_func(void *arg1, void *arg2, void *arg3) {
         //
         // While blocking, CPU is yielded to lower priority tasks.
         // Ensure that synthizer leaves a 20 ms slack.
-        ret = prepare_buffer(K_FOREVER, K_MSEC(Audio::BLOCK_DURATION_MS - 20));
+        ret = prepare_buffer(K_FOREVER, K_MSEC(Audio::BLOCK_DURATION_MS - 20), &is_idle);
         if (ret == -ETIMEDOUT) {
+            SYNTH_TRACE("render_overrun", 0, 0);
             Audio::clear_block();
             (void)led_set(LED_STATUS_4);
             overload_led_set = true;
@@ -113,13 +124,39 @@ static void synth_thread_func(void *arg1, void *arg2, void *arg3) {
         led_set(LED_STATUS_1);
         Audio::write_block();
         led_reset(LED_STATUS_1);
+
+        if (!is_idle) {
+            power_down_time = sys_timepoint_calc(K_MSEC(CONFIG_SYNTH_IDLE_POWER_DOWN_MS));
+            continue;
+        }
+
+        if (CONFIG_SYNTH_IDLE_POWER_DOWN_MS == 0 || !sys_timepoint_expired(power_down_time)) {
+            continue;
+        }
+
+        // Idle for long enough, stop the stream until the next note.
+        SYNTH_TRACE("power_down", 0, 0);
+        ret = Audio::stop_writes();
+        if (ret < 0) {
+            LOG_ERR("Failed to stop audio writes: %d", -ret);
+        }
+
+        Synthesizer::wait_for_note();
+
+        SYNTH_TRACE("power_up", 0, 0);
+        ret = start_stream();
+        if (ret < 0) {
+            LOG_ERR("Failed to restart audio writes: %d", -ret);
+            return;
+        }
+        power_down_time = sys_timepoint_calc(K_MSEC(CONFIG_SYNTH_IDLE_POWER_DOWN_MS));
     }
 }
 
 int main(void) {
     int ret;
 
-    constexpr auto usb_dev = DEVICE_DT_GET_ONE(zephyr_cdc_acm_uart);
+    constexpr auto usb_dev = DEVICE_DT_GET(DT_CHOSEN(serial_input));
     ret                    = USB::init(usb_dev);
     if (ret < 0) {
         LOG_ERR("USB initialization failed: %d", -ret);
@@ -140,6 +177,12 @@ int main(void) {
         return ret;
     }
 
+    ret = Telemetry::init();
+    if (ret < 0) {
+        USB::println("Telemetry initialization failed: %d", -ret);
+        return ret;
+    }
+
     ret = peripherals_init();
     if (ret < 0) {
         USB::println("Peripheral initialization failed: %d", -ret);
@@ -148,23 +191,56 @@ int main(void) {
 
     Synthesizer::init();
 
+#ifdef CONFIG_SYNTH_PRESETS
+    ret = Presets::init();
+    if (ret < 0) {
+        USB::println("Preset storage initialization failed: %d", -ret);
+    }
+#endif  // CONFIG_SYNTH_PRESETS
+
+#ifdef CONFIG_SYNTH_THREAD_STATS
+    ret = ThreadStats::init();
+    if (ret < 0) {
+        USB::println("Thread statistics initialization failed: %d", -ret);
+    }
+#endif  // CONFIG_SYNTH_THREAD_STATS
+
+#ifdef CONFIG_SYNTH_CAPTURE
+    ret = Capture::init();
+    if (ret < 0) {
+        USB::println("Capture initialization failed: %d", -ret);
+    }
+#endif  // CONFIG_SYNTH_CAPTURE
+
+#ifdef CONFIG_SYNTH_BENCHMARK
+    ret = Benchmark::run();
+    if (ret < 0) {
+        USB::println("Benchmark failed: %d", -ret);
+    }
+#endif  // CONFIG_SYNTH_BENCHMARK
+
     (void)USB::println("== Synthesizer up and running ==");
 
     (void)k_thread_create(&synth_thread, synth_stack, STACK_SIZE, synth_thread_func, nullptr,
                           NULL, NULL, -1, 0, K_NO_WAIT);
+    (void)k_thread_name_set(&synth_thread, "synth");
 
     (void)k_thread_create(
         &keyboard_thread, keyboard_stack, STACK_SIZE,
         [](void *_a, void *_b, void *_c) {
+            k_timeout_t timeout = K_FOREVER;
             while (true) {
+                // Woken up by the USB RX interrupt or when a timestamped event is
+                // due, no polling involved.
+                (void)USB::wait_for_data(timeout);
+
                 led_set(LED_DEBUG_1);
-                check_keyboard();
+                timeout = Keyboard::process();
                 led_reset(LED_DEBUG_1);
-
-                k_msleep(20);
             }
         },
         nullptr, nullptr, nullptr, 2, 0, K_NO_WAIT);
+    (void)k_thread_name_set(&keyboard_thread, "keyboard");
 
     return 0;
 }
@@ -3,7 +3,9 @@
 #include <sys/cdefs.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/logging/log_core.h>
+#include <zephyr/sys/util.h>
 
+#include "Input.hpp"
 #include "RotaryEncoder.hpp"
 #include "Switch.hpp"
 #include "Synthesizer.hpp"
@@ -37,82 +39,96 @@ enum peripheral_switch {
 };
 
 static Switch switches[SWITCH_COUNT] = {
-    [SWITCH_OSC_SEL]     = Switch(SWITCH_GPIO_PINS(sw_osc_sel),
-                                  [](const Switch::State state) {
-                                  Synthesizer::Mode oscillator;
-                                  switch (state) {
-                                      case Switch::DOWN:
-                                          oscillator = Synthesizer::Mode::OSC2;
-                                          break;
-                                      case Switch::NEUTRAL:
-                                          oscillator = Synthesizer::Mode::MASTER;
-                                          break;
-                                      case Switch::UP:
-                                          oscillator = Synthesizer::Mode::OSC1;
-                                          break;
-                                      default:
-                                          __unreachable();
-                                  }
-
-                                  Synthesizer::set_mode(oscillator);
-                              }),
-    [SWITCH_EFFECTS_SEL] = Switch(SWITCH_GPIO_PINS(sw_effects_sel),
-                                  [](const Switch::State state) {
-                                      Synthesizer::Effect effect;
-                                      switch (state) {
-                                          case Switch::DOWN:
-                                              effect = Synthesizer::Effect::SPECIAL;
-                                              break;
-                                          case Switch::NEUTRAL:
-                                              effect = Synthesizer::Effect::AMP_MOD;
-                                              break;
-                                          case Switch::UP:
-                                              effect = Synthesizer::Effect::LFO_MOD;
-                                              break;
-                                          default:
-                                              __unreachable();
-                                      }
-
-                                      Synthesizer::set_effect(effect);
-                                  }),
-    [SWITCH_EFFECTS_TARGET] =
-        Switch(SWITCH_GPIO_PINS(sw_effects_target),
-               [](const Switch::State state) {
-                   USB::println("Effects target switch not implemented yet.");
-               }),
-    [SWITCH_EFFECTS_CONF] =
-        Switch(SWITCH_GPIO_PINS(sw_effects_conf),
-               [](Switch::State state) {
-                   USB::println("Effects configuration switch not implemented yet.");
-               }),
+    [SWITCH_OSC_SEL]        = Switch(SWITCH_GPIO_PINS(sw_osc_sel)),
+    [SWITCH_EFFECTS_SEL]    = Switch(SWITCH_GPIO_PINS(sw_effects_sel)),
+    [SWITCH_EFFECTS_TARGET] = Switch(SWITCH_GPIO_PINS(sw_effects_target)),
+    [SWITCH_EFFECTS_CONF]   = Switch(SWITCH_GPIO_PINS(sw_effects_conf)),
 };
 
 static RotaryEncoder encoders[ENCODER_COUNT] = {
-    [ENCODER_OSC_WAVE] =
-        RotaryEncoder(ROTARY_ENCODER_PINS(enc_osc_wave), Synthesizer::change_waveform),
-    [ENCODER_OSC_PITCH] =
-        RotaryEncoder(ROTARY_ENCODER_PINS(enc_osc_pitch), Synthesizer::change_pitch),
-    [ENCODER_OSC_VOLUME] =
-        RotaryEncoder(ROTARY_ENCODER_PINS(enc_osc_volume), Synthesizer::change_volume),
+    [ENCODER_OSC_WAVE]   = RotaryEncoder(ROTARY_ENCODER_PINS(enc_osc_wave)),
+    [ENCODER_OSC_PITCH]  = RotaryEncoder(ROTARY_ENCODER_PINS(enc_osc_pitch)),
+    [ENCODER_OSC_VOLUME] = RotaryEncoder(ROTARY_ENCODER_PINS(enc_osc_volume)),
 };
 
-int peripherals_init(void) {
-    int ret;
+static void handle_switch(const enum peripheral_switch sw, const Switch::State state) {
+    switch (sw) {
+        case SWITCH_OSC_SEL: {
+            Synthesizer::Mode oscillator;
+            switch (state) {
+                case Switch::DOWN:
+                    oscillator = Synthesizer::Mode::OSC2;
+                    break;
+                case Switch::NEUTRAL:
+                    oscillator = Synthesizer::Mode::MASTER;
+                    break;
+                case Switch::UP:
+                    oscillator = Synthesizer::Mode::OSC1;
+                    break;
+                default:
+                    __unreachable();
+            }
+
+            Synthesizer::set_mode(oscillator);
+            break;
+        }
+        case SWITCH_EFFECTS_SEL: {
+            Synthesizer::Effect effect;
+            switch (state) {
+                case Switch::DOWN:
+                    effect = Synthesizer::Effect::SPECIAL;
+                    break;
+                case Switch::NEUTRAL:
+                    effect = Synthesizer::Effect::AMP_MOD;
+                    break;
+                case Switch::UP:
+                    effect = Synthesizer::Effect::LFO_MOD;
+                    break;
+                default:
+                    __unreachable();
+            }
+
+            Synthesizer::set_effect(effect);
+            break;
+        }
+        case SWITCH_EFFECTS_TARGET:
+            USB::println("Effects target switch not implemented yet.");
+            break;
+        case SWITCH_EFFECTS_CONF:
+            USB::println("Effects configuration switch not implemented yet.");
+            break;
+        default:
+            __unreachable();
+    }
+}
 
+static void handle_input(const Input::Events& events) {
+    // Apply the switches first so that encoder steps of the same scan land
+    // in the newly selected mode.
     for (unsigned int i = 0; i < SWITCH_COUNT; ++i) {
-        ret = switches[i].init();
-        if (ret < 0) {
-            LOG_ERR("Failed to initialize switch %d: %d", i, -ret);
-            return ret;
+        if (events.changed_switches & BIT(i)) {
+            handle_switch(static_cast<enum peripheral_switch>(i), events.switch_states[i]);
         }
     }
 
-    for (unsigned int i = 0; i < ENCODER_COUNT; ++i) {
-        ret = encoders[i].init();
-        if (ret < 0) {
-            LOG_ERR("Failed to initialize encoder %d: %d", i, -ret);
-            return ret;
-        }
+    if (events.encoder_deltas[ENCODER_OSC_WAVE] != 0) {
+        Synthesizer::change_waveform(events.encoder_deltas[ENCODER_OSC_WAVE]);
+    }
+    if (events.encoder_deltas[ENCODER_OSC_PITCH] != 0) {
+        Synthesizer::change_pitch(events.encoder_deltas[ENCODER_OSC_PITCH]);
+    }
+    if (events.encoder_deltas[ENCODER_OSC_VOLUME] != 0) {
+        Synthesizer::change_volume(events.encoder_deltas[ENCODER_OSC_VOLUME]);
+    }
+}
+
+int peripherals_init(void) {
+    int ret;
+
+    ret = Input::init(encoders, ENCODER_COUNT, switches, SWITCH_COUNT, handle_input);
+    if (ret < 0) {
+        LOG_ERR("Failed to initialize the input subsystem: %d", -ret);
+        return ret;
     }
 
     return 0;
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <zephyr/linker/section_tags.h>
+#include <zephyr/toolchain.h>
+
+// Memory placement of the render path. The F407 runs flash with wait states,
+// hidden only in part by the ART accelerator, while SRAM and CCM are zero wait
+// state. The CCM is on the data bus only: no code, and no DMA either.
+
+// Hot render code, copied from flash to SRAM at boot.
+#ifdef CONFIG_SYNTH_RAMFUNC
+#define SYNTH_HOT_CODE __ramfunc
+#else
+#define SYNTH_HOT_CODE
+#endif  // CONFIG_SYNTH_RAMFUNC
+
+// Read-only DSP tables, copied from flash to CCM at boot. A translation unit must
+// not mix them with SYNTH_VOICE_STATE, the sections would conflict.
+#ifdef CONFIG_SYNTH_CCM
+#define SYNTH_DSP_TABLE __ccm_data_section
+#else
+#define SYNTH_DSP_TABLE
+#endif  // CONFIG_SYNTH_CCM
+
+// Mutable per-voice state, zeroed in CCM at boot.
+#ifdef CONFIG_SYNTH_CCM
+#define SYNTH_VOICE_STATE __ccm_bss_section
+#else
+#define SYNTH_VOICE_STATE
+#endif  // CONFIG_SYNTH_CCM
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/tracing/tracing.h>
+
+// Application trace points, recorded as named events next to the kernel's scheduling
+// and ISR events. Names are truncated to 20 characters by the CTF backend.
+#ifdef CONFIG_SYNTH_TRACING
+#define SYNTH_TRACE(name, arg0, arg1) \
+    sys_trace_named_event(name, (uint32_t)(arg0), (uint32_t)(arg1))
+#else
+#define SYNTH_TRACE(name, arg0, arg1) \
+    do {                              \
+    } while (0)
+#endif  // CONFIG_SYNTH_TRACING
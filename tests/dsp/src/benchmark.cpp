@@ -0,0 +1,83 @@
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#ifdef CONFIG_TIMING_FUNCTIONS
+#include <zephyr/timing/timing.h>
+#endif  // CONFIG_TIMING_FUNCTIONS
+
+#include <cstdint>
+
+#include "Audio.hpp"
+#include "KeyPress.hpp"
+#include "Preset.hpp"
+#include "Synthesizer.hpp"
+#include "Synthesizer/Key.hpp"
+#include "Synthesizer/Noise.hpp"
+#include "Synthesizer/Oscillator.hpp"
+
+// Cycle counts for comparison across platforms, the render path is not timed
+// against a budget here.
+
+constexpr unsigned int BLOCKS = 4;
+
+static int16_t __aligned(4) block[Audio::SAMPLES_PER_BLOCK];
+
+#ifdef CONFIG_TIMING_FUNCTIONS
+static void *benchmark_setup(void) {
+    timing_init();
+    timing_start();
+    Synthesizer::init();
+    return nullptr;
+}
+
+static uint64_t cycles_of(void (*kernel)(void)) {
+    timing_t start = timing_counter_get();
+    for (unsigned int i = 0; i < BLOCKS; ++i) {
+        kernel();
+    }
+    timing_t end = timing_counter_get();
+
+    return timing_cycles_get(&start, &end);
+}
+
+ZTEST(benchmark, test_noise) {
+    const uint64_t cycles =
+        cycles_of([] { Noise::fill(block, Audio::SAMPLES_PER_BLOCK); });
+
+    TC_PRINT("noise: %llu cycles/sample\n", cycles / (BLOCKS * Audio::SAMPLES_PER_BLOCK));
+}
+
+ZTEST(benchmark, test_mixer) {
+    for (uint8_t wave = 0; wave <= Oscillator::NOISE; ++wave) {
+        Preset preset;
+        Synthesizer::get_preset(&preset);
+        preset.osc[Synthesizer::OSC1].wave = wave;
+        preset.osc[Synthesizer::OSC2].wave = wave;
+        Synthesizer::recall(preset);
+
+        Synthesizer::all_notes_off();
+        for (uint8_t voices = 1; voices <= MAX_KEYPRESSES; ++voices) {
+            Key key;
+            zassert_equal(Key::from_midi(60 + 4 * voices, &key), 0);
+            zassert_equal(Synthesizer::note_on(key, MAX_VELOCITY, K_FOREVER), 0);
+
+            const uint64_t cycles = cycles_of(
+                [] { zassert_equal(Synthesizer::synthesize(block, K_FOREVER), 0); });
+            TC_PRINT("mixer, wave %u, %u voices: %llu cycles/sample\n", wave, voices,
+                     cycles / (BLOCKS * Audio::SAMPLES_PER_BLOCK));
+        }
+    }
+    Synthesizer::all_notes_off();
+}
+#else
+static void *benchmark_setup(void) {
+    return nullptr;
+}
+
+ZTEST(benchmark, test_mixer) {
+    ztest_test_skip();
+}
+#endif  // CONFIG_TIMING_FUNCTIONS
+
+ZTEST_SUITE(benchmark, NULL, benchmark_setup, NULL, NULL, NULL);
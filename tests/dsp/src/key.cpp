@@ -0,0 +1,72 @@
+#include <errno.h>
+#include <stdint.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "Synthesizer/Key.hpp"
+
+constexpr uint8_t MIDI_NOTE_C4 = 60;
+constexpr uint8_t MIDI_NOTE_A4 = 69;
+
+static uint32_t increment_of(const uint8_t note) {
+    Key key;
+    (void)Key::from_midi(note, &key);
+    return key.phase_increment();
+}
+
+ZTEST(key, test_a4) {
+    // 440 Hz at 44.1 kHz, a full period spanning the 32-bit phase.
+    zassert_equal(increment_of(MIDI_NOTE_A4), 42852281);
+}
+
+ZTEST(key, test_octaves_double) {
+    for (uint8_t note = 0; note + 12 < Key::COUNT; ++note) {
+        zassert_within(increment_of(note + 12), 2 * increment_of(note), 1, "note %u", note);
+    }
+}
+
+ZTEST(key, test_semitones_rise) {
+    for (uint8_t note = 1; note < Key::COUNT; ++note) {
+        zassert_true(increment_of(note) > increment_of(note - 1), "note %u", note);
+    }
+}
+
+ZTEST(key, test_from_midi_range) {
+    Key key;
+
+    zassert_equal(Key::from_midi(0, &key), 0);
+    zassert_equal(Key::from_midi(Key::COUNT - 1, &key), 0);
+    zassert_equal(Key::from_midi(Key::COUNT, &key), -EINVAL);
+    zassert_equal(Key::from_midi(UINT8_MAX, &key), -EINVAL);
+}
+
+ZTEST(key, test_keymap) {
+    Key key;
+
+    // The home row from C4, sharps on the row above.
+    zassert_equal(Key::from_char('a', 0, &key), 0);
+    zassert_equal(key.midi_note(), MIDI_NOTE_C4);
+    zassert_equal(Key::from_char('w', 0, &key), 0);
+    zassert_equal(key.midi_note(), MIDI_NOTE_C4 + 1);
+    zassert_equal(Key::from_char(';', 0, &key), 0);
+    zassert_equal(key.midi_note(), MIDI_NOTE_C4 + 16);
+
+    zassert_equal(Key::from_char('q', 0, &key), -EINVAL);
+    zassert_equal(Key::from_char('A', 0, &key), -EINVAL);
+}
+
+ZTEST(key, test_keymap_octaves) {
+    Key key;
+
+    zassert_equal(Key::from_char('a', -4, &key), 0);
+    zassert_equal(key.midi_note(), MIDI_NOTE_C4 - 48);
+    zassert_equal(Key::from_char('a', 4, &key), 0);
+    zassert_equal(key.midi_note(), MIDI_NOTE_C4 + 48);
+
+    // Shifted past the end of the MIDI range.
+    zassert_equal(Key::from_char('a', -6, &key), -EINVAL);
+    zassert_equal(Key::from_char(';', 5, &key), -EINVAL);
+}
+
+ZTEST_SUITE(key, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,195 @@
+#include <errno.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "Audio.hpp"
+#include "KeyPress.hpp"
+#include "Preset.hpp"
+#include "Synthesizer.hpp"
+#include "Synthesizer/Key.hpp"
+#include "Synthesizer/Oscillator.hpp"
+#include "Synthesizer/Wavetable.hpp"
+
+constexpr unsigned int FRAME_COUNT = Audio::SAMPLES_PER_BLOCK / Audio::CHANNEL_COUNT;
+
+constexpr uint8_t MIDI_NOTE_A4 = 69;
+
+static int16_t __aligned(4) block[Audio::SAMPLES_PER_BLOCK];
+
+// Full-scale squares on both oscillators, without pitch shift.
+static const Preset SQUARES = {
+    .version = Preset::VERSION,
+    .osc =
+        {
+            {Oscillator::SQUARE, Oscillator::MAX_VOLUME, Oscillator::SHIFT_COUNT / 2, 0},
+            {Oscillator::SQUARE, Oscillator::MAX_VOLUME, Oscillator::SHIFT_COUNT / 2, 0},
+        },
+    .master_volume    = UINT8_MAX,
+    .filter_cutoff    = 0,
+    .filter_resonance = 0,
+    .effect           = Synthesizer::LFO_MOD,
+    .voice_mode       = Synthesizer::DUAL,
+    .mod_index        = 0,
+    .unison           = 1,
+    .detune           = 0,
+    .sample           = 0,
+};
+
+static Key key_of(const uint8_t note) {
+    Key key;
+    (void)Key::from_midi(note, &key);
+    return key;
+}
+
+static KeyPress *find_keypress(const Key &key) {
+    for (auto &keypress : keypresses) {
+        if (keypress.k == key && keypress.state != KeyPress::IDLE) {
+            return &keypress;
+        }
+    }
+    return nullptr;
+}
+
+static void *mixer_setup(void) {
+    Synthesizer::init();
+    return nullptr;
+}
+
+static void mixer_before(void *fixture) {
+    Synthesizer::all_notes_off();
+    Synthesizer::recall(SQUARES);
+}
+
+ZTEST(mixer, test_silence) {
+    zassert_equal(Synthesizer::synthesize(block, K_FOREVER), 0);
+
+    for (unsigned int i = 0; i < Audio::SAMPLES_PER_BLOCK; ++i) {
+        zassert_equal(block[i], 0, "sample %u", i);
+    }
+}
+
+ZTEST(mixer, test_single_voice_is_centered) {
+    zassert_equal(Synthesizer::note_on(key_of(MIDI_NOTE_A4), MAX_VELOCITY / 2, K_FOREVER), 0);
+    zassert_equal(Synthesizer::synthesize(block, K_FOREVER), 0);
+
+    bool has_sound = false;
+    for (unsigned int i = 0; i < Audio::SAMPLES_PER_BLOCK; i += Audio::CHANNEL_COUNT) {
+        zassert_equal(block[i], block[i + 1], "frame %u", i / Audio::CHANNEL_COUNT);
+        has_sound |= block[i] != 0;
+    }
+    zassert_true(has_sound);
+}
+
+ZTEST(mixer, test_phase_accumulator) {
+    const Key key = key_of(MIDI_NOTE_A4);
+
+    zassert_equal(Synthesizer::note_on(key, MAX_VELOCITY, K_FOREVER), 0);
+    KeyPress *const keypress = find_keypress(key);
+    zassert_not_null(keypress);
+
+    // The phase wraps around the 32-bit range without losing any step.
+    const uint32_t increment = key.phase_increment();
+    zassert_equal(Synthesizer::synthesize(block, K_FOREVER), 0);
+    zassert_equal(keypress->phase[Synthesizer::OSC1], increment * FRAME_COUNT);
+    zassert_equal(Synthesizer::synthesize(block, K_FOREVER), 0);
+    zassert_equal(keypress->phase[Synthesizer::OSC1], increment * FRAME_COUNT * 2);
+    zassert_equal(keypress->phase[Synthesizer::OSC2], keypress->phase[Synthesizer::OSC1]);
+}
+
+ZTEST(mixer, test_clipping) {
+    for (uint8_t i = 0; i < MAX_KEYPRESSES; ++i) {
+        zassert_equal(Synthesizer::note_on(key_of(MIDI_NOTE_A4 + i), MAX_VELOCITY, K_FOREVER),
+                      0);
+    }
+    zassert_equal(Synthesizer::note_on(key_of(MIDI_NOTE_A4 - 1), MAX_VELOCITY, K_FOREVER),
+                  -ENOMEM);
+
+    // Every square starts low, at twice full scale per voice.
+    zassert_equal(Synthesizer::synthesize(block, K_FOREVER), 0);
+    zassert_equal(block[0], INT16_MIN);
+    zassert_equal(block[1], INT16_MIN);
+}
+
+ZTEST(mixer, test_overrun) {
+    const uint32_t overruns = Synthesizer::get_overruns();
+
+    zassert_equal(Synthesizer::synthesize(block, K_NO_WAIT), -ETIMEDOUT);
+    zassert_equal(Synthesizer::get_overruns(), overruns + 1);
+}
+
+ZTEST(mixer, test_hold_time) {
+    zassert_equal(Synthesizer::note_on(key_of(MIDI_NOTE_A4), MAX_VELOCITY, K_NO_WAIT), 0);
+    zassert_equal(Synthesizer::synthesize(block, K_FOREVER), 0);
+
+    for (const auto &keypress : keypresses) {
+        zassert_equal(keypress.state, KeyPress::IDLE);
+    }
+    for (unsigned int i = 0; i < Audio::SAMPLES_PER_BLOCK; ++i) {
+        zassert_equal(block[i], 0, "sample %u", i);
+    }
+}
+
+ZTEST(mixer, test_recall_clamps) {
+    Preset preset = SQUARES;
+    preset.osc[Synthesizer::OSC1].wave = UINT8_MAX;
+    preset.voice_mode                  = UINT8_MAX;
+    preset.unison                      = 0;
+    Synthesizer::recall(preset);
+
+    Synthesizer::get_preset(&preset);
+    zassert_equal(preset.osc[Synthesizer::OSC1].wave, Oscillator::WaveType::COUNT - 1);
+    zassert_equal(preset.voice_mode, Synthesizer::VOICE_MODE_COUNT - 1);
+    zassert_equal(preset.unison, 1);
+}
+
+ZTEST(mixer, test_wavetable_swap_while_idle) {
+    const uint8_t samples[] = {0x00, 0x80, 0xff, 0x7f};
+    const uint32_t crc      = crc32_ieee_update(0, samples, sizeof(samples));
+
+    // Committed without any note playing, so without a block rendering.
+    zassert_equal(Wavetable::begin(1, 2, crc), 0);
+    zassert_equal(Wavetable::write(0, samples, sizeof(samples)), 0);
+    zassert_equal(Wavetable::commit(), 1);
+    zassert_equal(Wavetable::begin(1, 2, crc), -EBUSY);
+
+    Synthesizer::apply_pending();
+    zassert_equal(Wavetable::lookup(1, 0x0000), INT16_MIN);
+    zassert_equal(Wavetable::lookup(1, 0x8000), INT16_MAX);
+    zassert_equal(Wavetable::begin(1, 2, crc), 0);
+}
+
+ZTEST(mixer, test_render_offline_is_private) {
+    const Key key = key_of(MIDI_NOTE_A4);
+
+    zassert_equal(Synthesizer::note_on(key, MAX_VELOCITY, K_FOREVER), 0);
+    zassert_equal(Synthesizer::synthesize(block, K_FOREVER), 0);
+    KeyPress *const keypress = find_keypress(key);
+    zassert_not_null(keypress);
+    const uint32_t phase = keypress->phase[Synthesizer::OSC1];
+
+    KeyPress keys[MAX_KEYPRESSES];
+    keys[0].k     = key_of(MIDI_NOTE_A4 + 12);
+    keys[0].state = KeyPress::PRESSED;
+
+    Preset preset                      = SQUARES;
+    preset.osc[Synthesizer::OSC1].wave = Oscillator::SINE;
+    preset.osc[Synthesizer::OSC2].wave = Oscillator::SINE;
+
+    Synthesizer::begin_offline();
+    zassert_equal(Synthesizer::render_offline(block, keys, preset), 0);
+    Synthesizer::end_offline();
+
+    zassert_equal(keys[0].phase[Synthesizer::OSC1], keys[0].k.phase_increment() * FRAME_COUNT);
+    zassert_equal(keypress->phase[Synthesizer::OSC1], phase);
+    zassert_equal(keypress->state, KeyPress::PRESSED);
+
+    Synthesizer::get_preset(&preset);
+    zassert_equal(preset.osc[Synthesizer::OSC1].wave, Oscillator::SQUARE);
+    zassert_equal(preset.osc[Synthesizer::OSC2].wave, Oscillator::SQUARE);
+}
+
+ZTEST_SUITE(mixer, NULL, mixer_setup, mixer_before, NULL, NULL);
@@ -0,0 +1,50 @@
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "Synthesizer/Noise.hpp"
+
+constexpr unsigned int COUNT = 2048;
+
+static int16_t __aligned(4) buffer[COUNT + 2];
+
+ZTEST(noise, test_full_scale_and_centered) {
+    int16_t min = INT16_MAX;
+    int16_t max = INT16_MIN;
+    int64_t sum = 0;
+
+    Noise::fill(buffer, COUNT);
+    for (unsigned int i = 0; i < COUNT; ++i) {
+        min = MIN(min, buffer[i]);
+        max = MAX(max, buffer[i]);
+        sum += buffer[i];
+    }
+
+    zassert_true(min < INT16_MIN / 2 && max > INT16_MAX / 2, "range %d to %d", min, max);
+    // Five standard errors of the mean of a uniform full-scale signal.
+    zassert_within(sum / (int64_t)COUNT, 0, 5 * 18919 / 45, "mean %lld", sum / COUNT);
+}
+
+ZTEST(noise, test_blocks_differ) {
+    static int16_t __aligned(4) previous[COUNT];
+
+    Noise::fill(previous, COUNT);
+    Noise::fill(buffer, COUNT);
+
+    unsigned int same = 0;
+    for (unsigned int i = 0; i < COUNT; ++i) {
+        same += buffer[i] == previous[i];
+    }
+    zassert_true(same < COUNT / 100, "%u samples repeated", same);
+}
+
+ZTEST(noise, test_odd_count) {
+    // Odd counts are rounded up to a whole word, and not beyond.
+    buffer[4] = 0x5555;
+    Noise::fill(buffer, 3);
+    zassert_equal(buffer[4], 0x5555);
+}
+
+ZTEST_SUITE(noise, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,115 @@
+#include <stdint.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "Synthesizer/Oscillator.hpp"
+
+static Oscillator make_oscillator(const Oscillator::WaveType wave, const uint8_t volume) {
+    Oscillator osc;
+    osc.set_settings({
+        .wave       = (uint8_t)wave,
+        .volume     = volume,
+        .freq_shift = 0,
+        .table      = 0,
+    });
+    return osc;
+}
+
+ZTEST(oscillator, test_sine) {
+    Oscillator osc = make_oscillator(Oscillator::SINE, Oscillator::MAX_VOLUME);
+
+    zassert_within(osc.waveform(0x0000, 0), 0, 256);
+    zassert_within(osc.waveform(0x4000, 0), INT16_MAX, 64);
+    zassert_within(osc.waveform(0x8000, 0), 0, 256);
+    zassert_within(osc.waveform(0xc000, 0), INT16_MIN, 64);
+
+    // Odd symmetry half a period apart, within a step of the 1024-entry table.
+    for (uint32_t phase = 0; phase < 0x8000; phase += 0x40) {
+        zassert_within(osc.waveform(phase, 0), -osc.waveform(phase + 0x8000, 0), 256,
+                       "phase 0x%04x", phase);
+    }
+}
+
+ZTEST(oscillator, test_square) {
+    Oscillator osc = make_oscillator(Oscillator::SQUARE, Oscillator::MAX_VOLUME);
+
+    zassert_equal(osc.waveform(0x1000, 0), INT16_MIN);
+    zassert_equal(osc.waveform(0x7fff, 0), INT16_MIN);
+    zassert_equal(osc.waveform(0x8001, 0), INT16_MAX);
+    zassert_equal(osc.waveform(0xffff, 0), INT16_MAX);
+}
+
+ZTEST(oscillator, test_triangle) {
+    Oscillator osc = make_oscillator(Oscillator::TRIANGLE, Oscillator::MAX_VOLUME);
+
+    zassert_equal(osc.waveform(0x0000, 0), INT16_MIN);
+    zassert_equal(osc.waveform(0x4000, 0), 0);
+    zassert_equal(osc.waveform(0x7fff, 0), INT16_MAX - 1);
+    zassert_equal(osc.waveform(0xc000, 0), 0);
+
+    // Rising over the first half, falling over the second one.
+    for (uint32_t phase = 0x0100; phase < 0x7f00; phase += 0x100) {
+        zassert_true(osc.waveform(phase, 0) > osc.waveform(phase - 0x100, 0));
+        zassert_true(osc.waveform(phase + 0x8100, 0) < osc.waveform(phase + 0x8000, 0));
+    }
+}
+
+ZTEST(oscillator, test_sawtooth) {
+    Oscillator osc = make_oscillator(Oscillator::SAWTOOTH, Oscillator::MAX_VOLUME);
+
+    zassert_equal(osc.waveform(0x0000, 0), INT16_MIN);
+    zassert_equal(osc.waveform(0x8000, 0), 0);
+    zassert_equal(osc.waveform(0xffff, 0), INT16_MAX);
+}
+
+ZTEST(oscillator, test_noise_passes_through) {
+    Oscillator osc = make_oscillator(Oscillator::NOISE, Oscillator::MAX_VOLUME);
+
+    zassert_equal(osc.waveform(0x1234, -1234), -1234);
+    zassert_equal(osc.waveform(0x4321, 4321), 4321);
+}
+
+ZTEST(oscillator, test_volume) {
+    Oscillator full = make_oscillator(Oscillator::SAWTOOTH, Oscillator::MAX_VOLUME);
+    Oscillator half = make_oscillator(Oscillator::SAWTOOTH, Oscillator::MAX_VOLUME / 2);
+    Oscillator mute = make_oscillator(Oscillator::SAWTOOTH, 0);
+
+    zassert_equal(full.get_gain(), 0x8000);
+    zassert_equal(half.get_gain(), 0x4000);
+    zassert_equal(mute.get_gain(), 0);
+
+    // The waveform stays full scale, compute_sample() applies the volume.
+    zassert_equal(half.waveform(0xffff, 0), INT16_MAX);
+    zassert_equal(half.compute_sample(0xffff, 0), INT16_MAX / 2);
+    zassert_equal(mute.compute_sample(0xffff, 0), 0);
+}
+
+ZTEST(oscillator, test_settings_are_clamped) {
+    Oscillator osc;
+    osc.set_settings({
+        .wave       = UINT8_MAX,
+        .volume     = UINT8_MAX,
+        .freq_shift = UINT8_MAX,
+        .table      = UINT8_MAX,
+    });
+
+    const Oscillator::Settings settings = osc.get_settings();
+    zassert_equal(settings.wave, Oscillator::WaveType::COUNT - 1);
+    zassert_equal(settings.volume, Oscillator::MAX_VOLUME);
+    zassert_equal(settings.freq_shift, Oscillator::SHIFT_COUNT - 1);
+}
+
+ZTEST(oscillator, test_pitch_shift) {
+    Oscillator osc;
+
+    // Two octaves down, no shift and two octaves up.
+    osc.change_pitch(-Oscillator::SHIFT_COUNT);
+    zassert_equal(osc.get_phase_shift(), 0x4000);
+    osc.change_pitch(Oscillator::SHIFT_COUNT / 2);
+    zassert_equal(osc.get_phase_shift(), 0x10000);
+    osc.change_pitch(Oscillator::SHIFT_COUNT);
+    zassert_equal(osc.get_phase_shift(), 0x40000);
+}
+
+ZTEST_SUITE(oscillator, NULL, NULL, NULL, NULL, NULL);
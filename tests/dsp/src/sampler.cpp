@@ -0,0 +1,211 @@
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "Audio.hpp"
+#include "KeyPress.hpp"
+#include "Preset.hpp"
+#include "Synthesizer.hpp"
+#include "Synthesizer/Key.hpp"
+#include "Synthesizer/Oscillator.hpp"
+#include "Synthesizer/Sampler.hpp"
+#include "Synthesizer/sample_bank.h"
+
+constexpr uint8_t MIDI_NOTE_A4 = 69;
+
+// Laid out as scripts/wav2bank.py does: a guard sample before the data and two
+// after it.
+static const int16_t test_ramp_data[] = {0, 0, 100, 200, 300, 400, 500, 600, 700, 0, 0};
+static const int16_t test_bump_data[] = {0, 0, 0, 0, 1600, 0, 0, 0};
+static const int16_t test_loop_data[] = {100, 100, 200, 300, 400, 500, 600, 300, 400};
+
+SAMPLE_BANK_DEFINE(test_ramp, test_ramp_data, 8, Audio::SAMPLING_FREQUENCY, MIDI_NOTE_A4);
+SAMPLE_BANK_DEFINE(test_bump, test_bump_data, 5, Audio::SAMPLING_FREQUENCY, MIDI_NOTE_A4);
+SAMPLE_BANK_DEFINE(test_loop, test_loop_data, 2, Audio::SAMPLING_FREQUENCY, MIDI_NOTE_A4);
+
+static int16_t __aligned(4) block[Audio::SAMPLES_PER_BLOCK];
+
+static uint64_t position_of(const uint32_t sample, const uint32_t fraction = 0) {
+    return (uint64_t)sample << 32 | fraction;
+}
+
+static uint8_t index_of(const struct sample_bank &bank) {
+    for (unsigned int i = 0; i < Sampler::count(); ++i) {
+        if (Sampler::get(i) == &bank) {
+            return i;
+        }
+    }
+    return UINT8_MAX;
+}
+
+static const struct sample_bank *find_bank(const char *const name) {
+    for (unsigned int i = 0; i < Sampler::count(); ++i) {
+        if (strcmp(Sampler::get(i)->name, name) == 0) {
+            return Sampler::get(i);
+        }
+    }
+    return nullptr;
+}
+
+static bool has_sound(void) {
+    for (unsigned int i = 0; i < Audio::SAMPLES_PER_BLOCK; ++i) {
+        if (block[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Play a bank on a single A4 key
+/// @param bank the bank
+/// @return the key
+static KeyPress *play(const struct sample_bank &bank) {
+    Preset preset = {
+        .version = Preset::VERSION,
+        .osc =
+            {
+                {Oscillator::SINE, Oscillator::MAX_VOLUME, Oscillator::SHIFT_COUNT / 2, 0},
+                {Oscillator::SINE, Oscillator::MAX_VOLUME, Oscillator::SHIFT_COUNT / 2, 0},
+            },
+        .master_volume    = UINT8_MAX,
+        .filter_cutoff    = 0,
+        .filter_resonance = 0,
+        .effect           = Synthesizer::LFO_MOD,
+        .voice_mode       = Synthesizer::SAMPLE,
+        .mod_index        = 0,
+        .unison           = 1,
+        .detune           = 0,
+        .sample           = index_of(bank),
+    };
+    Synthesizer::recall(preset);
+
+    Key key;
+    (void)Key::from_midi(MIDI_NOTE_A4, &key);
+    if (Synthesizer::note_on(key, MAX_VELOCITY, K_FOREVER) < 0) {
+        return nullptr;
+    }
+
+    for (auto &keypress : keypresses) {
+        if (keypress.k == key && keypress.state != KeyPress::IDLE) {
+            return &keypress;
+        }
+    }
+    return nullptr;
+}
+
+static void *sampler_setup(void) {
+    Synthesizer::init();
+    return nullptr;
+}
+
+static void sampler_before(void *fixture) {
+    Synthesizer::all_notes_off();
+}
+
+ZTEST(sampler, test_guard_samples) {
+    zassert_true(Sampler::count() > 3, "no bank shipped");
+
+    // The shipped banks as well as the test ones.
+    for (unsigned int i = 0; i < Sampler::count(); ++i) {
+        const struct sample_bank &bank = *Sampler::get(i);
+        const int16_t *const x         = bank.data;
+
+        zassert_true(bank.length > 0, "%s", bank.name);
+        zassert_true(bank.loop_start <= bank.length, "%s", bank.name);
+        zassert_equal(x[-1], x[0], "%s", bank.name);
+        if (bank.loop_start < bank.length) {
+            const uint32_t next = bank.loop_start + 1 < bank.length ? bank.loop_start + 1
+                                                                    : bank.loop_start;
+            zassert_equal(x[bank.length], x[bank.loop_start], "%s", bank.name);
+            zassert_equal(x[bank.length + 1], x[next], "%s", bank.name);
+        } else {
+            zassert_equal(x[bank.length], 0, "%s", bank.name);
+            zassert_equal(x[bank.length + 1], 0, "%s", bank.name);
+        }
+    }
+    zassert_equal(Sampler::get(Sampler::count()), nullptr);
+}
+
+ZTEST(sampler, test_interpolate_at_samples) {
+    for (uint32_t i = 0; i < test_ramp.length; ++i) {
+        zassert_equal(Sampler::interpolate(test_ramp, position_of(i)), test_ramp.data[i],
+                      "sample %u", i);
+    }
+}
+
+ZTEST(sampler, test_interpolate_ramp) {
+    // Both the linear and the cubic interpolation follow a straight line.
+    for (uint32_t i = 1; i + 2 < test_ramp.length; ++i) {
+        zassert_equal(Sampler::interpolate(test_ramp, position_of(i, 1u << 31)), 100 * i + 50,
+                      "sample %u", i);
+        zassert_equal(Sampler::interpolate(test_ramp, position_of(i, 1u << 30)), 100 * i + 25,
+                      "sample %u", i);
+    }
+}
+
+ZTEST(sampler, test_interpolate_curve) {
+    // Halfway between two silent samples, ahead of a peak.
+    const int16_t y = Sampler::interpolate(test_bump, position_of(1, 1u << 31));
+
+#ifdef CONFIG_SYNTH_SAMPLE_INTERPOLATION_CUBIC
+    // The Catmull-Rom spline dips before it rises: (9 * 0 + 9 * 0 - 0 - 1600) / 16.
+    zassert_equal(y, -100);
+#else
+    zassert_equal(y, 0);
+#endif  // CONFIG_SYNTH_SAMPLE_INTERPOLATION_CUBIC
+}
+
+ZTEST(sampler, test_advance_one_shot) {
+    const uint64_t end = position_of(test_ramp.length);
+
+    zassert_equal(Sampler::advance(test_ramp, end - 1, 1), end);
+    zassert_equal(Sampler::advance(test_ramp, end, position_of(3)), end + position_of(3));
+}
+
+ZTEST(sampler, test_advance_wraps) {
+    // Samples 2 to 5 loop.
+    zassert_equal(Sampler::advance(test_loop, position_of(5), position_of(1)), position_of(2));
+    zassert_equal(Sampler::advance(test_loop, position_of(5, 1u << 31), position_of(2)),
+                  position_of(3, 1u << 31));
+
+    // A step spanning the loop many times over lands where stepping sample by
+    // sample would.
+    const uint64_t step = position_of(4001, 1u << 31);
+    zassert_equal(Sampler::advance(test_loop, position_of(5), step), position_of(2, 1u << 31));
+}
+
+ZTEST(sampler, test_shipped_bank_loops) {
+    const struct sample_bank *const bank = find_bank("tone");
+    zassert_not_null(bank);
+    zassert_true(bank->loop_start < bank->length);
+
+    KeyPress *const keypress = play(*bank);
+    zassert_not_null(keypress);
+
+    // Played at its root note, a block runs through the whole bank.
+    zassert_ok(Synthesizer::synthesize(block, K_FOREVER));
+    zassert_true(has_sound());
+    zassert_between_inclusive(keypress->sample_position >> 32, bank->loop_start,
+                              bank->length - 1);
+}
+
+ZTEST(sampler, test_bank_change_restarts) {
+    const struct sample_bank *const bank = find_bank("tone");
+    zassert_not_null(bank);
+
+    KeyPress *const keypress = play(*bank);
+    zassert_not_null(keypress);
+    zassert_ok(Synthesizer::synthesize(block, K_FOREVER));
+    zassert_true(keypress->sample_position >> 32 >= test_loop.length);
+
+    // The position lies past the end of the shorter bank, which still plays.
+    zassert_ok(Synthesizer::set_sample(index_of(test_loop)));
+    zassert_ok(Synthesizer::synthesize(block, K_FOREVER));
+    zassert_true(has_sound());
+    zassert_true(keypress->sample_position >> 32 < test_loop.length);
+}
+
+ZTEST_SUITE(sampler, NULL, sampler_setup, sampler_before, NULL, NULL);
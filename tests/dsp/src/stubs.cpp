@@ -0,0 +1,18 @@
+// Stand-ins for the modules the render path reports to, so that it runs without
+// the codec or the USB console.
+
+#include <stdint.h>
+
+#include <cstdint>
+
+#include "Audio.hpp"
+#include "Synthesizer.hpp"
+#include "Telemetry.hpp"
+
+void Audio::set_volume_async(const uint8_t volume) {}
+
+uint8_t Audio::get_codec_volume(void) {
+    return UINT8_MAX;
+}
+
+void Telemetry::post(const Param param, const Synthesizer::Mode mode, const int32_t value) {}
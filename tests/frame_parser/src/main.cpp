@@ -0,0 +1,179 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "FrameParser.hpp"
+
+using Result = FrameParser::Result;
+
+constexpr unsigned int FRAME_OVERHEAD = 4;
+
+static FrameParser parser;
+
+/// @brief Lay a frame out as it is sent on the wire
+/// @param type frame type
+/// @param payload the payload
+/// @param length payload length
+/// @param wire the frame, FRAME_OVERHEAD bytes longer than the payload
+/// @return the frame size
+static size_t make_frame(const uint8_t type, const uint8_t *const payload,
+                         const uint8_t length, uint8_t *const wire) {
+    uint8_t checksum = type + length;
+    for (unsigned int i = 0; i < length; ++i) {
+        checksum += payload[i];
+    }
+
+    wire[0] = FrameParser::SYNC;
+    wire[1] = type;
+    wire[2] = length;
+    memcpy(&wire[3], payload, length);
+    wire[3 + length] = -checksum;
+
+    return length + FRAME_OVERHEAD;
+}
+
+/// @brief Feed bytes to the parser, which should only have a result for the last one
+/// @param stream the bytes
+/// @param size number of bytes
+/// @return result of the last byte, or the first result before it
+static Result feed_all(const uint8_t *const stream, const size_t size) {
+    for (size_t i = 0; i + 1 < size; ++i) {
+        const Result result = parser.feed(stream[i]);
+        if (result != FrameParser::NONE) {
+            return result;
+        }
+    }
+    return parser.feed(stream[size - 1]);
+}
+
+static void frame_parser_before(void *fixture) {
+    parser.reset();
+}
+
+ZTEST(frame_parser, test_frame) {
+    const uint8_t payload[] = {0x00, 0x3c, 0x7f, 0x00, 0x10, 0x00};
+    uint8_t wire[sizeof(payload) + FRAME_OVERHEAD];
+
+    const size_t size = make_frame(0x01, payload, sizeof(payload), wire);
+    zassert_equal(feed_all(wire, size), FrameParser::FRAME);
+    zassert_true(parser.is_idle());
+
+    const FrameParser::Frame &frame = parser.get_frame();
+    zassert_equal(frame.type, 0x01);
+    zassert_equal(frame.length, sizeof(payload));
+    zassert_mem_equal(frame.payload, payload, sizeof(payload));
+}
+
+ZTEST(frame_parser, test_empty_frame) {
+    uint8_t wire[FRAME_OVERHEAD];
+
+    const size_t size = make_frame(0x04, nullptr, 0, wire);
+    zassert_equal(feed_all(wire, size), FrameParser::FRAME);
+    zassert_equal(parser.get_frame().length, 0);
+}
+
+ZTEST(frame_parser, test_max_length_frame) {
+    static uint8_t payload[FrameParser::MAX_PAYLOAD];
+    static uint8_t wire[FrameParser::MAX_PAYLOAD + FRAME_OVERHEAD];
+
+    for (unsigned int i = 0; i < sizeof(payload); ++i) {
+        payload[i] = i * 7;
+    }
+
+    const size_t size = make_frame(0x03, payload, sizeof(payload), wire);
+    zassert_equal(feed_all(wire, size), FrameParser::FRAME);
+    zassert_equal(parser.get_frame().length, FrameParser::MAX_PAYLOAD);
+    zassert_mem_equal(parser.get_frame().payload, payload, sizeof(payload));
+}
+
+ZTEST(frame_parser, test_checksum_error) {
+    const uint8_t payload[] = {0x01, 0x02, 0x03};
+    uint8_t wire[sizeof(payload) + FRAME_OVERHEAD];
+
+    const size_t size = make_frame(0x01, payload, sizeof(payload), wire);
+    wire[4] ^= 0x10;
+    zassert_equal(feed_all(wire, size), FrameParser::CHECKSUM_ERROR);
+    zassert_true(parser.is_idle());
+
+    // The next frame is parsed as usual.
+    wire[4] ^= 0x10;
+    zassert_equal(feed_all(wire, size), FrameParser::FRAME);
+}
+
+ZTEST(frame_parser, test_sync_in_payload) {
+    // SYNC bytes within a frame are data, not the start of another frame.
+    const uint8_t payload[] = {FrameParser::SYNC, 0x01, FrameParser::SYNC};
+    uint8_t wire[sizeof(payload) + FRAME_OVERHEAD];
+
+    const size_t size = make_frame(FrameParser::SYNC, payload, sizeof(payload), wire);
+    zassert_equal(feed_all(wire, size), FrameParser::FRAME);
+    zassert_equal(parser.get_frame().type, FrameParser::SYNC);
+    zassert_mem_equal(parser.get_frame().payload, payload, sizeof(payload));
+}
+
+ZTEST(frame_parser, test_passthrough) {
+    const char text[] = "asdf;\r\n";
+
+    for (unsigned int i = 0; i < strlen(text); ++i) {
+        zassert_equal(parser.feed(text[i]), FrameParser::PASSTHROUGH);
+        zassert_true(parser.is_idle());
+    }
+}
+
+ZTEST(frame_parser, test_passthrough_between_frames) {
+    const uint8_t payload[] = {0x42};
+    uint8_t wire[sizeof(payload) + FRAME_OVERHEAD];
+
+    const size_t size = make_frame(0x01, payload, sizeof(payload), wire);
+    zassert_equal(parser.feed('a'), FrameParser::PASSTHROUGH);
+    zassert_equal(feed_all(wire, size), FrameParser::FRAME);
+    zassert_equal(parser.feed('s'), FrameParser::PASSTHROUGH);
+    zassert_equal(feed_all(wire, size), FrameParser::FRAME);
+}
+
+ZTEST(frame_parser, test_truncated_frame_reset) {
+    const uint8_t payload[] = {0x10, 0x20, 0x30, 0x40};
+    uint8_t wire[sizeof(payload) + FRAME_OVERHEAD];
+
+    const size_t size = make_frame(0x02, payload, sizeof(payload), wire);
+
+    // The receiver drops a frame which stalls midway, as the keyboard thread
+    // does once the frame timeout expires.
+    for (size_t i = 0; i < size / 2; ++i) {
+        zassert_equal(parser.feed(wire[i]), FrameParser::NONE);
+    }
+    zassert_false(parser.is_idle());
+    parser.reset();
+
+    zassert_equal(parser.feed('a'), FrameParser::PASSTHROUGH);
+    zassert_equal(feed_all(wire, size), FrameParser::FRAME);
+}
+
+ZTEST(frame_parser, test_truncated_frame_resync) {
+    const uint8_t payload[] = {0x10, 0x20, 0x30, 0x40};
+    uint8_t wire[sizeof(payload) + FRAME_OVERHEAD];
+
+    const size_t size = make_frame(0x02, payload, sizeof(payload), wire);
+
+    // Without a reset, the truncated frame swallows the start of the next one
+    // and fails its checksum. The parser is back in sync from the frame after.
+    unsigned int errors = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        (void)parser.feed(wire[i]);
+    }
+    for (size_t i = 0; i < size; ++i) {
+        const Result result = parser.feed(wire[i]);
+        zassert_not_equal(result, FrameParser::FRAME);
+        errors += result == FrameParser::CHECKSUM_ERROR;
+    }
+    zassert_equal(errors, 1);
+    zassert_true(parser.is_idle());
+
+    zassert_equal(feed_all(wire, size), FrameParser::FRAME);
+    zassert_mem_equal(parser.get_frame().payload, payload, sizeof(payload));
+}
+
+ZTEST_SUITE(frame_parser, NULL, NULL, frame_parser_before, NULL, NULL);
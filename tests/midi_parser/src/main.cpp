@@ -0,0 +1,151 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "MidiParser.hpp"
+
+using Event = MidiParser::Event;
+
+constexpr unsigned int MAX_EVENTS = 16;
+
+static MidiParser parser;
+static Event events[MAX_EVENTS];
+
+/// @brief Replay a recorded stream through the parser
+/// @param stream the received bytes
+/// @param size number of bytes
+/// @return number of events parsed into events[]
+static unsigned int replay(const uint8_t *const stream, const size_t size) {
+    unsigned int count = 0;
+    for (size_t i = 0; i < size && count < MAX_EVENTS; ++i) {
+        count += parser.feed(stream[i], &events[count]);
+    }
+    return count;
+}
+
+static void assert_event(const Event &event, const Event::Type type, const uint8_t channel,
+                         const uint8_t data1, const uint8_t data2) {
+    zassert_equal(event.type, type);
+    zassert_equal(event.channel, channel);
+    zassert_equal(event.data1, data1);
+    zassert_equal(event.data2, data2);
+}
+
+static void midi_parser_before(void *fixture) {
+    parser.reset();
+}
+
+ZTEST(midi_parser, test_note_on_off) {
+    const uint8_t stream[] = {0x90, 60, 100, 0x80, 60, 64};
+
+    zassert_equal(replay(stream, sizeof(stream)), 2);
+    assert_event(events[0], Event::NOTE_ON, 0, 60, 100);
+    assert_event(events[1], Event::NOTE_OFF, 0, 60, 64);
+}
+
+ZTEST(midi_parser, test_running_status) {
+    // A chord on channel 3, then released with zero velocity note-ons.
+    const uint8_t stream[] = {0x92, 60, 90, 64, 91, 67, 92, 60, 0, 64, 0, 67, 0};
+
+    zassert_equal(replay(stream, sizeof(stream)), 6);
+    assert_event(events[0], Event::NOTE_ON, 2, 60, 90);
+    assert_event(events[1], Event::NOTE_ON, 2, 64, 91);
+    assert_event(events[2], Event::NOTE_ON, 2, 67, 92);
+    assert_event(events[3], Event::NOTE_OFF, 2, 60, 0);
+    assert_event(events[4], Event::NOTE_OFF, 2, 64, 0);
+    assert_event(events[5], Event::NOTE_OFF, 2, 67, 0);
+}
+
+ZTEST(midi_parser, test_velocity_zero_is_note_off) {
+    const uint8_t stream[] = {0x9f, 42, 0};
+
+    zassert_equal(replay(stream, sizeof(stream)), 1);
+    assert_event(events[0], Event::NOTE_OFF, 15, 42, 0);
+}
+
+ZTEST(midi_parser, test_real_time_mid_message) {
+    // Clock, start, active sensing and reset between the bytes of a message.
+    const uint8_t stream[] = {0xf8, 0x90, 0xfa, 60, 0xfe, 100, 0xf8, 62, 0xff, 101};
+
+    zassert_equal(replay(stream, sizeof(stream)), 2);
+    assert_event(events[0], Event::NOTE_ON, 0, 60, 100);
+    assert_event(events[1], Event::NOTE_ON, 0, 62, 101);
+}
+
+ZTEST(midi_parser, test_sysex_is_skipped) {
+    // An identity reply, with a clock tick in the middle, then a note.
+    const uint8_t stream[] = {0xf0, 0x7e, 0x00, 0x06, 0x02, 0x41, 0xf8, 0x10,
+                              0x20, 0xf7, 0x91, 48,   80};
+
+    zassert_equal(replay(stream, sizeof(stream)), 1);
+    assert_event(events[0], Event::NOTE_ON, 1, 48, 80);
+}
+
+ZTEST(midi_parser, test_sysex_cancels_running_status) {
+    const uint8_t stream[] = {0x90, 60, 100, 0xf0, 0x01, 0x02, 0xf7, 62, 100};
+
+    zassert_equal(replay(stream, sizeof(stream)), 1);
+    assert_event(events[0], Event::NOTE_ON, 0, 60, 100);
+}
+
+ZTEST(midi_parser, test_unterminated_sysex) {
+    // A status byte ends a sysex whose end byte went missing.
+    const uint8_t stream[] = {0xf0, 0x01, 0x02, 0x90, 60, 100};
+
+    zassert_equal(replay(stream, sizeof(stream)), 1);
+    assert_event(events[0], Event::NOTE_ON, 0, 60, 100);
+}
+
+ZTEST(midi_parser, test_system_common_is_skipped) {
+    // Song position, song select and time code, each followed by a note.
+    const uint8_t stream[] = {0xf2, 0x10, 0x20, 0x90, 60, 100, 0xf3, 0x05,
+                              0x90, 61, 100,  0xf1, 0x33, 0x90, 62, 100};
+
+    zassert_equal(replay(stream, sizeof(stream)), 3);
+    for (unsigned int i = 0; i < 3; ++i) {
+        assert_event(events[i], Event::NOTE_ON, 0, 60 + i, 100);
+    }
+}
+
+ZTEST(midi_parser, test_unsupported_messages) {
+    // Aftertouch, program change and channel pressure, with running status.
+    const uint8_t stream[] = {0xa0, 60, 10, 0xc0, 5, 6, 0xd0, 20, 21, 0xb0, 7, 100};
+
+    zassert_equal(replay(stream, sizeof(stream)), 1);
+    assert_event(events[0], Event::CONTROL_CHANGE, 0, 7, 100);
+}
+
+ZTEST(midi_parser, test_stray_data_bytes) {
+    // Data bytes received before any status are dropped.
+    const uint8_t stream[] = {60, 100, 0x80, 60, 0};
+
+    zassert_equal(replay(stream, sizeof(stream)), 1);
+    assert_event(events[0], Event::NOTE_OFF, 0, 60, 0);
+}
+
+ZTEST(midi_parser, test_pitch_bend_range) {
+    const uint8_t stream[] = {0xe0, 0x00, 0x00, 0x00, 0x40, 0x7f, 0x7f, 0x01, 0x40};
+
+    zassert_equal(replay(stream, sizeof(stream)), 4);
+    for (unsigned int i = 0; i < 4; ++i) {
+        zassert_equal(events[i].type, Event::PITCH_BEND);
+    }
+    zassert_equal(events[0].bend(), -8192);
+    zassert_equal(events[1].bend(), 0);
+    zassert_equal(events[2].bend(), 8191);
+    zassert_equal(events[3].bend(), 1);
+}
+
+ZTEST(midi_parser, test_reset) {
+    const uint8_t partial[] = {0x90, 60};
+    const uint8_t stream[]  = {100, 62, 100};
+
+    zassert_equal(replay(partial, sizeof(partial)), 0);
+    parser.reset();
+    zassert_equal(replay(stream, sizeof(stream)), 0);
+}
+
+ZTEST_SUITE(midi_parser, NULL, NULL, midi_parser_before, NULL, NULL);
@@ -0,0 +1,207 @@
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/ztest.h>
+
+#include <cstdint>
+
+#include "Preset.hpp"
+#include "Presets.hpp"
+#include "Synthesizer.hpp"
+
+#define PRESETS_PARTITION_ID FIXED_PARTITION_ID(storage_partition)
+
+// As laid down by Presets.
+constexpr uint32_t FCB_MAGIC  = 0x53594e54;
+constexpr uint8_t FCB_VERSION = 1;
+
+// Enough saves to fill the whole partition twice over.
+constexpr unsigned int ROTATE_SAVES =
+    2 * FIXED_PARTITION_SIZE(storage_partition) / sizeof(Preset);
+
+constexpr unsigned int SLOT = 3;
+
+// The engine as Presets sees it: the state it snapshots, the last preset it
+// recalled and whether a note plays.
+static Preset current;
+static Preset recalled;
+static unsigned int recall_count;
+static bool playing;
+
+void Synthesizer::get_preset(Preset *const preset) {
+    *preset = current;
+}
+
+void Synthesizer::recall(const Preset &preset) {
+    recalled = preset;
+    ++recall_count;
+}
+
+bool Synthesizer::is_playing(void) {
+    return playing;
+}
+
+/// @brief Get a valid preset which differs for every seed
+/// @param seed the seed
+/// @return the preset
+static Preset preset_of(const unsigned int seed) {
+    Preset preset        = {};
+    preset.version       = Preset::VERSION;
+    preset.osc[0].volume = Oscillator::MAX_VOLUME;
+    preset.osc[1].volume = Oscillator::MAX_VOLUME;
+    preset.master_volume = seed;
+    preset.mod_index     = seed >> 8;
+    preset.unison        = 1;
+    return preset;
+}
+
+/// @brief Check the last recalled preset
+/// @param seed seed of the expected preset
+/// @return true if the last recalled preset is the expected one
+static bool recalled_is(const unsigned int seed) {
+    const Preset expected = preset_of(seed);
+    return memcmp(&recalled, &expected, sizeof(expected)) == 0;
+}
+
+/// @brief Count the entries of the log, as found on flash
+/// @return the entry count, -ERRNO on failure
+static int count_records(void) {
+    static struct flash_sector sectors[4];
+    static struct fcb fcb;
+    uint32_t sector_count = ARRAY_SIZE(sectors);
+    int count             = 0;
+    int ret;
+
+    ret = flash_area_get_sectors(PRESETS_PARTITION_ID, &sector_count, sectors);
+    if (ret < 0) {
+        return ret;
+    }
+
+    fcb              = {};
+    fcb.f_magic      = FCB_MAGIC;
+    fcb.f_version    = FCB_VERSION;
+    fcb.f_sector_cnt = sector_count;
+    fcb.f_sectors    = sectors;
+    ret              = fcb_init(PRESETS_PARTITION_ID, &fcb);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = fcb_walk(
+        &fcb, nullptr,
+        [](struct fcb_entry_ctx *const ctx, void *const arg) -> int {
+            ++*static_cast<int *>(arg);
+            return 0;
+        },
+        &count);
+
+    return ret < 0 ? ret : count;
+}
+
+static void presets_before(void *fixture) {
+    const struct flash_area *area;
+
+    zassert_ok(flash_area_open(PRESETS_PARTITION_ID, &area));
+    zassert_ok(flash_area_erase(area, 0, area->fa_size));
+    flash_area_close(area);
+
+    current      = preset_of(0);
+    recall_count = 0;
+    playing      = false;
+
+    zassert_ok(Presets::init());
+}
+
+ZTEST(presets, test_save_load) {
+    zassert_equal(Presets::load(SLOT), -ENOENT);
+    zassert_equal(Presets::save(Presets::SLOT_COUNT), -EINVAL);
+
+    current = preset_of(1);
+    zassert_ok(Presets::save(SLOT));
+    current = preset_of(2);
+    zassert_ok(Presets::load(SLOT));
+    zassert_true(recalled_is(1));
+
+    // Read back from flash, where the autosave slot is recalled at boot.
+    zassert_ok(Presets::save(Presets::AUTOSAVE_SLOT));
+    zassert_ok(Presets::init());
+    zassert_equal(recall_count, 2);
+    zassert_true(recalled_is(2));
+    zassert_ok(Presets::load(SLOT));
+    zassert_true(recalled_is(1));
+}
+
+ZTEST(presets, test_same_preset_is_skipped) {
+    current = preset_of(1);
+    zassert_ok(Presets::save(SLOT));
+    zassert_equal(count_records(), 1);
+
+    zassert_ok(Presets::save(SLOT));
+    zassert_equal(count_records(), 1);
+
+    // Another slot still gets its own entry.
+    zassert_ok(Presets::save(SLOT + 1));
+    zassert_equal(count_records(), 2);
+
+    current = preset_of(2);
+    zassert_ok(Presets::save(SLOT));
+    zassert_equal(count_records(), 3);
+}
+
+ZTEST(presets, test_rotation_carries_slots_over) {
+    current = preset_of(1);
+    zassert_ok(Presets::save(SLOT));
+
+    for (unsigned int i = 0; i < ROTATE_SAVES; ++i) {
+        current = preset_of(i + 2);
+        zassert_ok(Presets::save(SLOT + 1), "save %u", i);
+    }
+
+    // Older entries were erased, but no slot lost its latest one.
+    zassert_between_inclusive(count_records(), 1, (int)ROTATE_SAVES - 1);
+    zassert_ok(Presets::init());
+    zassert_ok(Presets::load(SLOT));
+    zassert_true(recalled_is(1));
+    zassert_ok(Presets::load(SLOT + 1));
+    zassert_true(recalled_is(ROTATE_SAVES + 1));
+}
+
+ZTEST(presets, test_rotation_deferred_while_playing) {
+    unsigned int saves = 0;
+    int ret            = 0;
+
+    playing = true;
+    while (saves < ROTATE_SAVES) {
+        current = preset_of(saves + 1);
+        ret     = Presets::save(SLOT);
+        if (ret < 0) {
+            break;
+        }
+        ++saves;
+    }
+    zassert_equal(ret, -EAGAIN);
+
+    // The full log is left as it is.
+    zassert_ok(Presets::load(SLOT));
+    zassert_true(recalled_is(saves));
+
+    // The autosave waits for the notes to stop.
+    Presets::schedule_autosave();
+    k_msleep(CONFIG_SYNTH_PRESET_AUTOSAVE_DELAY_MS * 3);
+    zassert_equal(Presets::load(Presets::AUTOSAVE_SLOT), -ENOENT);
+
+    playing = false;
+    k_msleep(CONFIG_SYNTH_PRESET_AUTOSAVE_DELAY_MS * 3);
+    zassert_ok(Presets::load(Presets::AUTOSAVE_SLOT));
+    zassert_mem_equal(&recalled, &current, sizeof(Preset));
+    zassert_ok(Presets::load(SLOT));
+    zassert_true(recalled_is(saves));
+
+    current = preset_of(saves + 1);
+    zassert_ok(Presets::save(SLOT));
+}
+
+ZTEST_SUITE(presets, NULL, NULL, presets_before, NULL, NULL);